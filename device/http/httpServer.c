@@ -163,8 +163,8 @@ thread httpServer(int netDescrp, int gentcpdev)
         if (semcount(activeXWeb) <= 0)
         {
             sprintf(thrname, "XWeb_%d", (devtab[gentcpdev].minor));
-            ready(create((void *)httpServer, INITSTK, INITPRIO,
-                         thrname, 2, netDescrp, gentcpdev), RESCHED_NO);
+            ready(clone((void *)httpServer, INITPRIO,
+                        thrname, 2, netDescrp, gentcpdev), RESCHED_NO);
         }
 
         /* Did not consume http device, just waited for availability */
@@ -173,8 +173,8 @@ thread httpServer(int netDescrp, int gentcpdev)
     else
     {
         sprintf(thrname, "XWeb_%d", (devtab[gentcpdev].minor));
-        ready(create((void *)httpServer, INITSTK, INITPRIO,
-                     thrname, 2, netDescrp, gentcpdev), RESCHED_NO);
+        ready(clone((void *)httpServer, INITPRIO,
+                    thrname, 2, netDescrp, gentcpdev), RESCHED_NO);
     }
 
     return OK;
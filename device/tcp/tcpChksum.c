@@ -14,10 +14,29 @@
  */
 ushort tcpChksum(struct packet *pkt, ushort len, struct netaddr *src,
                  struct netaddr *dst)
+{
+    return tcpChksumHdr(pkt, len, src, dst, len, 0);
+}
+
+/**
+ * @ingroup tcp
+ *
+ * Calculate the checksum of a TCP packet whose trailing data has already
+ * been summed, as by netChksumCopy() while copying it into the packet.
+ * @param pkt packet holding the TCP segment
+ * @param len length of the TCP segment
+ * @param src source IP address
+ * @param dst destination IP address
+ * @param sumlen length of the segment to sum here, which must be even
+ * @param datasum partial checksum of the rest of the segment
+ * @return the checksum of the TCP segment
+ */
+ushort tcpChksumHdr(struct packet *pkt, ushort len, struct netaddr *src,
+                    struct netaddr *dst, ushort sumlen, uint datasum)
 {
     struct tcpPseudo *pseu;
     uchar buf[TCP_PSEUDO_LEN];
-    ushort sum;
+    uint sum;
 
     /* Store current data before TCP header in temporary buffer */
     pseu = (struct tcpPseudo *)(pkt->curr - TCP_PSEUDO_LEN);
@@ -30,10 +49,10 @@ ushort tcpChksum(struct packet *pkt, ushort len, struct netaddr *src,
     pseu->proto = IPv4_PROTO_TCP;
     pseu->len = hs2net(len);
 
-    sum = netChksum(pseu, len + TCP_PSEUDO_LEN);
+    sum = netChksumAdd(datasum, pseu, sumlen + TCP_PSEUDO_LEN);
 
     /* Restore data before TCP header from temporary buffer */
     memcpy(pseu, buf, TCP_PSEUDO_LEN);
 
-    return sum;
+    return netChksumFold(sum);
 }
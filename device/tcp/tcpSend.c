@@ -31,6 +31,7 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
     int result;
     uchar *data;
     uint i = 0;
+    uint first, datasum, sum;
     ushort window = 0;
     ushort msslen = 0;
     ushort tcplen;
@@ -94,12 +95,27 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
         TCP_TRACE("Added MSS");
     }
 
-    /* Copy data into packet */
+    /* Copy data into packet, summing it on the way for the checksum.  The
+     * output buffer is a ring, so the data may wrap around to its start. */
+    datasum = 0;
     if (datalen > 0)
     {
-        for (i = 0; i < datalen; i++)
+        datastart %= TCP_OBLEN;
+        first = TCP_OBLEN - datastart;
+        if (first > datalen)
         {
-            *data++ = tcbptr->out[(datastart + i) % TCP_OBLEN];
+            first = datalen;
+        }
+        datasum = netChksumCopy(data, &tcbptr->out[datastart], first);
+        if (first < datalen)
+        {
+            sum = netChksumCopy(data + first, tcbptr->out, datalen - first);
+            /* A sum taken from an odd offset has its bytes swapped */
+            if (first & 1)
+            {
+                sum = ((sum & 0xFF) << 8) | (sum >> 8);
+            }
+            datasum += sum;
         }
     }
 
@@ -112,8 +128,9 @@ int tcpSend(struct tcb *tcbptr, uchar ctrl, uint seqnum,
     tcp->urgent = hs2net(tcp->urgent);
 
     /* Calculate TCP checksum */
-    tcp->chksum = tcpChksum(pkt, tcplen, &tcbptr->localip,
-                            &tcbptr->remoteip);
+    tcp->chksum = tcpChksumHdr(pkt, tcplen, &tcbptr->localip,
+                               &tcbptr->remoteip, TCP_HDR_LEN + msslen,
+                               datasum);
 
     /* Send TCP packet */
     result = ipv4Send(pkt, &tcbptr->localip, &tcbptr->remoteip,
@@ -4,7 +4,6 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
-#include <clock.h>
 #include <interrupt.h>
 #include <semaphore.h>
 #include <stddef.h>
@@ -14,118 +13,89 @@
 
 struct tcpEvent tcptimertab[TCP_NEVENTS];
 semaphore tcpmutex;
+tid_typ tcptimertid;
 
-static int calcElapsed(int, int);
+/* Set when an event expires, cleared before each scan for expired events */
+static bool tcpexpired;
 
 /**
  * @ingroup tcp
  *
- * TCP timer process to manage timeout and retransmit events.
+ * TCP timer process to manage timeout and retransmit events.  Each event
+ * runs on a clock timer; when one expires the thread is resumed to trigger
+ * it, and it suspends itself again once no expired events remain.
  */
 thread tcpTimer(void)
 {
-    struct tcpEvent *first = NULL;
-    struct tcpEvent *head = NULL;
-    ulong lastticks;
-    ulong lasttime;
-    ulong elapse;
+    struct tcpEvent *evtptr = NULL;
     irqmask ps;
     uchar type;
     struct tcb *tcbptr = NULL;
+    int evt;
 
-    /* Setup timer event delta queue */
+    /* Setup timer event table */
     bzero(tcptimertab, sizeof(struct tcpEvent) * TCP_NEVENTS);
     tcpmutex = semcreate(1);
-    head = &tcptimertab[TCP_EVT_HEAD];
-    head->used = TRUE;
-    head->next = NULL;
+    tcpexpired = FALSE;
+    tcptimertid = gettid();
 
     TCP_TRACE("Timer init complete");
-    /* Initialize timer accounting information */
-    ps = disable();
-    lastticks = clkticks;
-    lasttime = clktime;
-    elapse = 0;
-    restore(ps);
-    sleep(TCP_FREQ);
 
     while (TRUE)
     {
-//              TCP_TRACE("Tick");
+        ps = disable();
+        tcpexpired = FALSE;
+        restore(ps);
+
         wait(tcpmutex);
-        while ((head->next != NULL) && (elapse > 0))
+        for (evt = 0; evt < TCP_NEVENTS; evt++)
         {
-            first = head->next;
-            if (first->remain > elapse)
+            evtptr = &tcptimertab[evt];
+            if (!evtptr->used || !evtptr->expired)
             {
-                first->remain -= elapse;
-                break;
+                continue;
             }
 
-            elapse -= first->remain;
-            first->remain = 0;
-            while ((first != NULL) && (first->remain <= 0))
-            {
-                /* Save event information and update pointers */
-                type = first->type;
-                tcbptr = first->tcbptr;
-                first->used = FALSE;
-                head->next = first->next;
-
-                /* Release mutex in case triggered event needs it */
-                signal(tcpmutex);
+            /* Save event information and free the record */
+            type = evtptr->type;
+            tcbptr = evtptr->tcbptr;
+            evtptr->used = FALSE;
+            evtptr->expired = FALSE;
 
-                /* Trigger event */
-                tcpTimerTrigger(type, tcbptr);
+            /* Release mutex in case triggered event needs it */
+            signal(tcpmutex);
 
-                /* Reclaim mutex */
-                wait(tcpmutex);
+            /* Trigger event */
+            tcpTimerTrigger(type, tcbptr);
 
-                /* Obtain first event (which may have changed while 
-                 * mutex was released) */
-                first = head->next;
-            }
+            /* Reclaim mutex */
+            wait(tcpmutex);
         }
         signal(tcpmutex);
 
         ps = disable();
-        elapse = calcElapsed(lastticks, lasttime);
-        restore(ps);
-
-//        sleep(TCP_FREQ - elapse);
-        sleep(TCP_FREQ);
-
-        ps = disable();
-        elapse = calcElapsed(lastticks, lasttime);
-        lastticks = clkticks;
-        lasttime = clktime;
+        if (!tcpexpired)
+        {
+            suspend(tcptimertid);
+        }
         restore(ps);
     }
     return OK;
 }
 
 /**
- * Calulates the number of milliseconds elapsed.
- * @param lastticks last value of clock ticks
- * @param lasttime last value of clock time
- * @return number of milliseconds elapsed between the time provided and now 
- * @precondition interrupts are disabled
- * @postcondition interrupts are still disabled
+ * @ingroup tcp
+ *
+ * Timer function for TCP events, called from the clock interrupt.  Marks
+ * the event expired and resumes the TCP timer thread to trigger it.
+ * @param evt index of the expired event in tcptimertab
  */
-static int calcElapsed(int lastticks, int lasttime)
+void tcpTimerExpire(int evt)
 {
-    int ticks = 0;
-
-    if (lasttime == clktime)
-    {
-        ticks = clkticks - lastticks;
-    }
-    else
+    tcptimertab[evt].expired = TRUE;
+    tcpexpired = TRUE;
+    if (THRSUSP == thrtab[tcptimertid].state)
     {
-        ticks = CLKTICKS_PER_SEC - lastticks;
-        ticks += (clktime - lasttime - 1) * CLKTICKS_PER_SEC;
-        ticks += clkticks;
+        ready(tcptimertid, RESCHED_NO);
     }
-
-    return (ticks * (CLKTICKS_PER_SEC / 1000));
 }
@@ -4,6 +4,8 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <clock.h>
+#include <interrupt.h>
 #include <semaphore.h>
 #include <stddef.h>
 #include <tcp.h>
@@ -19,31 +21,28 @@
  */
 devcall tcpTimerPurge(struct tcb *tcbptr, uchar type)
 {
-    struct tcpEvent *prev = NULL;
     struct tcpEvent *cur = NULL;
     int result = SYSERR;
+    irqmask ps;
+    int evt;
 
     wait(tcpmutex);
-    prev = &tcptimertab[TCP_EVT_HEAD];
-    cur = prev->next;
-    while (cur != NULL)
+    for (evt = 0; evt < TCP_NEVENTS; evt++)
     {
-        if ((cur->tcbptr == tcbptr)
+        cur = &tcptimertab[evt];
+        if (cur->used && (cur->tcbptr == tcbptr)
             && ((NULL == type) || (cur->type == type)))
         {
+            ps = disable();
             if (SYSERR == result)
             {
-                result = cur->time - cur->remain;
+                result = cur->time
+                    - (tmremain(&cur->timer) * 1000) / CLKTICKS_PER_SEC;
             }
-            if (cur->next != NULL)
-            {
-                cur->next->remain += cur->remain;
-            }
-            prev->next = cur->next;
+            tmcancel(&cur->timer);
+            restore(ps);
             cur->used = FALSE;
         }
-        prev = cur;
-        cur = cur->next;
     }
     signal(tcpmutex);
 
@@ -4,6 +4,7 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <clock.h>
 #include <semaphore.h>
 #include <stddef.h>
 #include <tcp.h>
@@ -19,19 +20,19 @@
 int tcpTimerRemain(struct tcb *tcbptr, uchar type)
 {
     struct tcpEvent *cur = NULL;
-    int time = 0;
+    int time;
+    int evt;
 
     wait(tcpmutex);
-    cur = tcptimertab[TCP_EVT_HEAD].next;
-    while (cur != NULL)
+    for (evt = 0; evt < TCP_NEVENTS; evt++)
     {
-        time += cur->remain;
-        if ((cur->tcbptr == tcbptr) && (cur->type == type))
+        cur = &tcptimertab[evt];
+        if (cur->used && (cur->tcbptr == tcbptr) && (cur->type == type))
         {
+            time = (tmremain(&cur->timer) * 1000) / CLKTICKS_PER_SEC;
             signal(tcpmutex);
             return time;
         }
-        cur = cur->next;
     }
     signal(tcpmutex);
 
@@ -4,6 +4,7 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
+#include <clock.h>
 #include <semaphore.h>
 #include <stddef.h>
 #include <tcp.h>
@@ -23,8 +24,6 @@ devcall tcpTimerSched(int time, struct tcb *tcbptr, uchar type)
 {
     int evt = 0;
     struct tcpEvent *evtptr = NULL;
-    struct tcpEvent *prev = NULL;
-    struct tcpEvent *next = NULL;
 
     /* Verify parameters */
     if ((time < 0) || (NULL == tcbptr))
@@ -44,23 +43,11 @@ devcall tcpTimerSched(int time, struct tcb *tcbptr, uchar type)
     evtptr->time = time;
     evtptr->type = type;
     evtptr->tcbptr = tcbptr;
+    evtptr->expired = FALSE;
 
-    /* Insert event into delta queue */
-    prev = &tcptimertab[TCP_EVT_HEAD];
-    next = prev->next;
-    while ((next != NULL) && (next->remain <= time))
-    {
-        time -= next->remain;
-        prev = next;
-        next = next->next;
-    }
-    evtptr->next = next;
-    prev->next = evtptr;
-    evtptr->remain = time;
-    if (next != NULL)
-    {
-        next->remain -= time;
-    }
+    /* Start the event's clock timer */
+    tmset(&evtptr->timer, (time * CLKTICKS_PER_SEC) / 1000,
+          tcpTimerExpire, evt);
     signal(tcpmutex);
 
     return OK;
@@ -77,15 +64,10 @@ static int allocEvent(void)
     int evt;
     static int nextevt = 0;
 
-    /* Check all TCP timer event slots (except the head) */
+    /* Check all TCP timer event slots */
     for (evt = 0; evt < TCP_NEVENTS; evt++)
     {
         nextevt = (nextevt + 1) % TCP_NEVENTS;
-        /* Ignore head */
-        if (TCP_EVT_HEAD == nextevt)
-        {
-            continue;
-        }
         if (FALSE == tcptimertab[nextevt].used)
         {
             tcptimertab[nextevt].used = TRUE;
@@ -23,10 +23,30 @@
 ushort udpChksum(struct packet *pkt, ushort len, const struct netaddr *src,
                  const struct netaddr *dst)
 {
+    return udpChksumHdr(pkt, len, src, dst, len, 0);
+}
+
+/**
+ * @ingroup udpinternal
+ *
+ * Calculate the checksum of a UDP packet whose trailing data has already
+ * been summed, as by netChksumCopy() while copying it into the packet.
+ * @param udppkt UDP packet to calculate checksum for
+ * @param len Length of UDP packet
+ * @param src Source IP Address
+ * @param dst Destination IP Address
+ * @param sumlen Length of the UDP packet to sum here, which must be even
+ * @param datasum Partial checksum of the rest of the packet
+ * @return The checksum of the UDP packet
+ */
+ushort udpChksumHdr(struct packet *pkt, ushort len,
+                    const struct netaddr *src, const struct netaddr *dst,
+                    ushort sumlen, uint datasum)
+{
 
     struct udpPseudoHdr *pseu;
     struct udpPseudoHdr temp;
-    ushort sum;
+    uint sum;
 
     pseu = ((struct udpPseudoHdr *)(pkt->curr)) - 1;
     memcpy(&temp, pseu, sizeof(struct udpPseudoHdr));
@@ -38,9 +58,9 @@ ushort udpChksum(struct packet *pkt, ushort len, const struct netaddr *src,
     pseu->proto = IPv4_PROTO_UDP;
     pseu->len = hs2net(len);
 
-    sum = netChksum(pseu, len + sizeof(struct udpPseudoHdr));
+    sum = netChksumAdd(datasum, pseu, sumlen + sizeof(struct udpPseudoHdr));
 
     memcpy(pseu, &temp, sizeof(struct udpPseudoHdr));
 
-    return sum;
+    return netChksumFold(sum);
 }
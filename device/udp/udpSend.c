@@ -46,6 +46,7 @@ syscall udpSend(struct udp *udpptr, ushort datalen, const void *buf)
     struct packet *pkt;
     struct udpPkt *udppkt;
     struct netaddr localip, remoteip;
+    uint datasum;
     int result;
 
     pkt = netGetbuf();
@@ -89,6 +90,9 @@ syscall udpSend(struct udp *udpptr, ushort datalen, const void *buf)
             netFreebuf(pkt);
             return SYSERR;
         }
+
+        /* Calculate UDP checksum (which happens to be the same as TCP's) */
+        udppkt->chksum = udpChksum(pkt, datalen, &localip, &remoteip);
     }
     else
     {
@@ -106,11 +110,13 @@ syscall udpSend(struct udp *udpptr, ushort datalen, const void *buf)
         udppkt->len = hs2net(pkt->len);
         udppkt->chksum = 0;
 
-        memcpy(udppkt->data, buf, datalen - UDP_HDR_LEN);
-    }
+        /* Copy the data, summing it on the way for the checksum */
+        datasum = netChksumCopy(udppkt->data, buf, datalen - UDP_HDR_LEN);
 
-    /* Calculate UDP checksum (which happens to be the same as TCP's) */
-    udppkt->chksum = udpChksum(pkt, datalen, &localip, &remoteip);
+        /* Calculate UDP checksum from the header and the data's sum */
+        udppkt->chksum = udpChksumHdr(pkt, datalen, &localip, &remoteip,
+                                      UDP_HDR_LEN, datasum);
+    }
 
     /* Send the UDP packet through IP */
     result = ipv4Send(pkt, &localip, &remoteip, IPv4_PROTO_UDP);
@@ -19,9 +19,19 @@
  */
 #define CLKTICKS_PER_SEC  1000
 
+/**
+ * @ingroup timer
+ *
+ * Most ticks a tickless clock lets pass between timer interrupts.  The
+ * clock is tickless when built with -DCLK_TICKLESS; the x86 PIT's 16-bit
+ * counter holds at most 55 ticks.
+ */
+#ifndef CLK_MAXSKIP
+#define CLK_MAXSKIP  50
+#endif
+
 extern volatile ulong clkticks;
 extern volatile ulong clktime;
-extern qid_typ sleepq;
 
 /* Clock function prototypes.  Note:  clkupdate() and clkcount() are documented
  * here because their implementations are platform-dependent.  */
@@ -55,6 +65,7 @@ void clkupdate(ulong cycles);
 ulong clkcount(void);
 
 interrupt clkhandler(void);
+void wakeup(int);
 void udelay(ulong);
 void mdelay(ulong);
 
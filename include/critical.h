@@ -0,0 +1,66 @@
+/**
+ * @file critical.h
+ * Profiling of critical sections run with interrupts disabled.
+ *
+ * Kernel code which brackets a critical section with CS_DISABLE() and
+ * CS_RESTORE() instead of disable() and restore() has the time interrupts
+ * stay masked charged to the enclosing function in a table, dumped by the
+ * `irqstat` shell command.  Only the outermost section is timed, so a
+ * primitive called with interrupts already disabled adds nothing of its
+ * own.  Sections are told apart by a nesting depth, which resched() saves
+ * and restores with each thread since a thread may switch out mid-section.
+ *
+ * Profiling is off by default, leaving the macros plain disable() and
+ * restore().  To turn it on, set IRQPROF to TRUE in the platform's
+ * xinu.conf and rebuild.
+ *
+ * A section during which the thread is switched out, as when wait() blocks,
+ * is counted as switched instead of timed: the interval includes other
+ * threads running, and the masking up to the switch is resched()'s.
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#ifndef _CRITICAL_H_
+#define _CRITICAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <conf.h>
+#include <interrupt.h>
+
+#ifndef IRQPROF
+#define IRQPROF     FALSE
+#endif
+
+#define NCSENT      64          /**< functions profiled, power of two   */
+
+/**
+ * Critical section table entry, one per function
+ */
+struct csent
+{
+    const char *name;           /**< function, or NULL if entry unused  */
+    ulong count;                /**< sections timed                     */
+    ulong max;                  /**< longest section, in cycles         */
+    uint64_t total;             /**< sum of sections, in cycles         */
+    ulong switched;             /**< sections which switched threads    */
+};
+
+extern struct csent cstab[NCSENT];
+extern ulong csswitches;
+extern uint csdepth;
+
+irqmask csdisable(const char *);
+void csrestore(irqmask, const char *);
+void csdump(void);
+void csclear(void);
+
+#if IRQPROF
+#define CS_DISABLE()        csdisable(__func__)
+#define CS_RESTORE(im)      csrestore((im), __func__)
+#else
+#define CS_DISABLE()        disable()
+#define CS_RESTORE(im)      restore(im)
+#endif
+
+#endif                          /* _CRITICAL_H_ */
@@ -7,10 +7,33 @@
 #define _FRAME_ALLOC_H_
 
 #include <stddef.h>
+#include <conf.h>
 #include <paging.h>
 
 #define FRAME_SIZE 4096
 
+// Watermarks of the pool of zeroed frames, which may be set in xinu.conf. The null thread
+// refills the pool once it drops below ZPOOL_LOW, up to ZPOOL_HIGH
+#ifndef ZPOOL_LOW
+#define ZPOOL_LOW  16
+#endif
+#ifndef ZPOOL_HIGH
+#define ZPOOL_HIGH 64
+#endif
+
+// Frames below dmazoneend form the DMA zone, kept for buffers which devices reach by physical
+// address, such as descriptor rings. Other allocations only take frames from it once the rest of
+// memory is used up. The zone ends at DMA_ZONE_END, or at half of memory if that is lower.
+// DMA_ZONE_END must be a multiple of LARGE_PAGE_SIZE and may be set in xinu.conf
+#ifndef DMA_ZONE_END
+#define DMA_ZONE_END 0x01000000
+#endif
+
+// Zones which framealloc_contig() can be asked to allocate from
+#define FRAMEZONE_DMA    0      // Only frames below dmazoneend
+#define FRAMEZONE_NORMAL 1      // Frames anywhere, preferring those above dmazoneend
+#define NFRAMEZONES      2
+
 // FRAME ALLOCATION
 // framelist is a pointer to the first entry of the bitmap frame table
 extern uint *framelist;
@@ -18,12 +41,50 @@ extern uint *framelist;
 extern uint numframetableentries;
 // The base physical address of the lowest frame which can be allocated
 extern uint framebaseaddr;
-// An int corresponding to the last allocated frame
+// framesummary is a pointer to the second level of the bitmap, where each bit marks a full framelist word
+extern uint *framesummary;
+// The number of entries in the summary table
+extern uint numsummaryentries;
+// An int corresponding to the last allocated frame, used as the starting hint for the next search
 extern uint lastallocatedframe;
+// The number of frames currently free
+extern uint numfreeframes;
+// The number of frames in the DMA zone, which are the lowest ones, and the address it ends at
+extern uint dmazoneframes;
+extern uint dmazoneend;
+// framerefs holds one byte per frame counting its references beyond the first
+extern uchar *framerefs;
+
+// Fragmentation of the frame bitmap, as measured by framestat()
+struct framestat {
+  uint free;                    // Frames free in the bitmap, not counting the zeroed pool
+  uint dmafree;                 // Of those, frames free in the DMA zone
+  uint runs;                    // Runs of consecutive free frames
+  uint largestrun;              // Frames in the longest run
+  uint largespans;              // Entirely free spans which could back a large page
+};
+
+// ZEROED FRAME POOL
+// The number of zeroed frames waiting in the pool, which numfreeframes counts as free
+extern uint zeropoolcount;
+// Calls to framealloc_zeroed() served from the pool, and those which had to zero a frame
+extern ulong zeropoolhits;
+extern ulong zeropoolmisses;
 
 // Function prototypes
 uint framealloc(void);
+uint framealloc_n(uint nframes);
+uint framealloc_large(void);
+uint framealloc_largezeroed(void);
+bool framelargeready(void);
+uint framealloc_contig(uint nframes, uint align, uint zone);
+uint framealloc_zeroed(void);
+bool zeropoolfill(void);
+void framestat(struct framestat *stat);
 void freeframe(uint frameaddr);
+void freeframe_n(uint frameaddr, uint nframes);
+syscall frameref(uint frameaddr);
+uint framerefcount(uint frameaddr);
 syscall initframealloc(void);
 uint truncframe(uint addr);
 uint roundframe(uint addr);
@@ -8,11 +8,19 @@
 
 #include <semaphore.h>
 #include <stddef.h>
+#include <thread.h>
 #include <conf.h>
 
 #define MAILBOX_FREE     0
 #define MAILBOX_ALLOC    1
 
+/* Most ints one mailbox can hold, messages times words per message.  Each
+ * mailbox has a ring this size in kernel memory, which every thread's page
+ * directory maps, so may be set in xinu.conf. */
+#ifndef MAILBOX_MAXINTS
+#define MAILBOX_MAXINTS  1024
+#endif
+
 /**
  * Defines what an entry in the mailbox table looks like.
  */
@@ -21,10 +29,12 @@ struct mbox
     semaphore sender;           /**< count of free spaces in mailbox    */
     semaphore receiver;         /**< count of messages ready to recieve */
     uint max;                   /**< max #of messages mailbox can hold  */
+    uint words;                 /**< #of ints in each message           */
     uint count;                 /**< #of msgs currently in mailbox      */
     uint start;                 /**< index into buffer of first msg     */
     uchar state;                /**< state of the mailbox               */
-    int *msgs;                  /**< message queue for the mailbox      */
+    int *msgs;                  /**< message ring, in kernel memory     */
+    tid_typ selector;           /**< thread in mailboxSelect(), or BADTID */
 };
 
 typedef uint mailbox;
@@ -35,10 +45,19 @@ extern struct mbox mboxtab[];
 
 /* Mailbox function prototypes */
 syscall mailboxAlloc(uint);
+syscall mailboxAllocWords(uint, uint);
 syscall mailboxCount(mailbox);
 syscall mailboxFree(mailbox);
 syscall mailboxInit(void);
 syscall mailboxReceive(mailbox);
 syscall mailboxSend(mailbox, int);
+syscall mailboxReceiveBatch(mailbox, int *, uint);
+syscall mailboxSendBatch(mailbox, const int *, uint);
+syscall mailboxTryReceive(mailbox);
+syscall mailboxTrySend(mailbox, int);
+syscall mailboxReceiveTime(mailbox, int);
+syscall mailboxSelect(const mailbox *, uint, int);
+void mailboxNotify(mailbox);
+void mailboxUnselect(tid_typ);
 
 #endif                          /* _MAILBOX_H_ */
@@ -43,6 +43,33 @@ struct memblock
 
 extern struct memblock memlist;     /**< head of free memory list           */
 
+/*
+ * Slab size classes.  memget() serves requests up to SLAB_MAXSIZE bytes from
+ * per-thread free lists of power-of-two sized objects, refilled by carving
+ * SLAB_CHUNK bytes at a time from the thread's memlist.
+ */
+#define SLAB_MINSHIFT   4                       /**< smallest is 16 bytes */
+#define SLAB_MAXSHIFT   11                      /**< largest is 2 KiB     */
+#define NSLAB           (SLAB_MAXSHIFT - SLAB_MINSHIFT + 1)
+#define SLAB_MAXSIZE    (1 << SLAB_MAXSHIFT)
+#define SLAB_CHUNK      4096                    /**< bytes per refill     */
+
+/*
+ * Returning free heap pages to the frame allocator.  memfree() unmaps the
+ * pages of a free block at least MEMTRIM_BYTES long straight away; smaller
+ * frees are left resident for reuse until MEMTRIM_BYTES of them have built
+ * up, when memtrim() sweeps the whole memlist.
+ */
+#define MEMTRIM_BYTES   (16 * 4096)             /**< 16 pages             */
+
+/*
+ * Heap growth.  A thread's heap runs from USERSPACE_BASE up to its break,
+ * and its memlist only covers memory below the break.  memget() raises the
+ * break in multiples of HEAP_CHUNK when no free block fits, and memtrim()
+ * lowers it again over a free block of at least HEAP_CHUNK at the top.
+ */
+#define HEAP_CHUNK      (16 * 4096)             /**< 16 pages             */
+
 /* Other memory data */
 
 extern void *_end;              /**< linker provides end of image       */
@@ -51,6 +78,12 @@ extern void *memheap;           /**< bottom of heap                     */
 /* Memory function prototypes */
 void *memget(uint);
 syscall memfree(void *, uint);
+syscall memtrim(void);
+syscall brk(void *);
+void *sbrk(int);
 void *stkget(uint);
+void *slabget(uint);
+void slabfree(void *, uint);
+uint slabsize(uint);
 
 #endif                          /* _MEMORY_H_ */
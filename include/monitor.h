@@ -18,6 +18,7 @@
 #define MUSED 0x02 /**< this monitor is used */
 
 #define NOOWNER BADTID /**< no thread owns this monitor's lock */
+#define NOMON   (-1)   /**< thread is not waiting to lock a monitor */
 
 /** type definition of "monitor" */
 typedef unsigned int monitor;
@@ -31,6 +32,7 @@ struct monent
     tid_typ owner;    /**< thread that owns the lock, or NOOWNER if unowned  */
     uint count;       /**< number of lock actions performed  */
     semaphore sem;    /**< semaphore used by this monitor  */
+    int ceiling;      /**< priority of the owner while locked, or 0  */
 };
 
 extern struct monent montab[];
@@ -44,5 +46,7 @@ syscall unlock(monitor);
 monitor moncreate(void);
 syscall monfree(monitor);
 syscall moncount(monitor);
+syscall monceiling(monitor, int);
+void moninherit(tid_typ);
 
 #endif /* _MONITOR_H */
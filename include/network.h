@@ -144,6 +144,9 @@ struct packet
 
 /* Function Prototypes */
 ushort netChksum(void *, uint);
+uint netChksumAdd(uint, const void *, uint);
+uint netChksumCopy(void *, const void *, uint);
+ushort netChksumFold(uint);
 syscall netDown(int);
 syscall netFreebuf(struct packet *);
 struct packet *netGetbuf(void);
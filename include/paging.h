@@ -9,23 +9,88 @@
 #include <stddef.h>
 
 #define KERNELSPACE_BASE 0x00000000
-#define USERSPACE_BASE   0x00400000
+#define KERNELSPACE_END  0x00400000   // Identity mapped by page directory entry 0
+#define USERSPACE_BASE   0x00800000
 #define USERSPACE_END    0xFFC00000
 
+// Temporary kernel mappings: KMAP_SLOTS pages at the bottom of the 4MB between kernel and user
+// space, which kmap() points at arbitrary frames so foreign paging structures can be edited.
+// Their page table, kmaptable, is shared by every page directory
+#define KMAP_SLOTS       8
+#define KMAP_BASE        KERNELSPACE_END
+
+// A large page, mapped by a page directory entry with PAGE_LARGE set
+#define LARGE_PAGE_SIZE  0x00400000
+#define LARGE_FRAMES     (LARGE_PAGE_SIZE / 0x1000)
+
 // Equals the value of the pos'th bit in var
 #define get_bit(var,pos) ((var) & (1<<pos))
 
+// Flag bits in page directory and page table entries
+#define PAGE_PRESENT     0x00000001
+#define PAGE_RW          0x00000002
+#define PAGE_LARGE       0x00000080   // Directory entry maps a 4MB page (CR4.PSE) rather than a table
+#define PAGE_GLOBAL      0x00000100   // Kept in the TLB across CR3 reloads once CR4.PGE is set
+#define PAGE_COW         0x00000200   // Available bit: read-only copy of a frame shared with another directory
+#define PAGE_SHARED      0x00000400   // Available bit: frame of a shared memory segment, writable by every directory
+
+// Summary of the page tables present in a directory, one bit per page directory entry,
+// so teardown only visits the tables which exist
+#define PTMAP_WORDS      (1024 / 32)
+#define ptmapset(map, i)   ((map)[(i) >> 5] |= (1 << ((i) & 31)))
+#define ptmapclear(map, i) ((map)[(i) >> 5] &= ~(1 << ((i) & 31)))
+
+// Bits of the error code pushed by the CPU on a page fault
+#define PF_PRESENT       0x00000001   // Fault was a protection violation on a present page
+#define PF_WRITE         0x00000002   // Faulting access was a write
+
+// Counts from walking the user part of a page directory with pagewalk()
+struct pagestat {
+  uint tables;                  // Page tables present
+  uint pages;                   // Pages present, large pages counting LARGE_FRAMES each
+  uint shared;                  // Pages shared copy-on-write
+  uint large;                   // Large pages present
+};
+
 // PAGING STRUCTURES
 
-// Address of page table for identity mapping the kernel space
+// Address of page table for identity mapping the kernel space, NULL when it is a large page
 extern uint *kernelidentitytable;
+// Page directory entry 0 of every directory, which maps the kernel space
+extern uint kernelpde;
+// Address of the page table holding the kmap() slots
+extern uint *kmaptable;
+// Whether large pages (CR4.PSE) are enabled for user memory
+extern bool largepages;
+
+// Context switches which reloaded CR3
+extern ulong cr3reloads;
 
 // Memory function prototypes
 void initpagetable(uint *tablebaseaddr);
-void reclaimframes(uint *pagedir);
-void pageregion(uint regionstart, uint regionend);
-void pageregionwith(uint regionstart, uint regionend, uint *pagedir, uint *ptemodifier, uint *virtualpagetableaddr);
+void reclaimframes(uint *pagedir, uint *ptmap);
+void reclaimtable(uint *oldpagedir, uint i);
+uint pageregion(uint regionstart, uint regionend);
+uint pageregionwith(uint regionstart, uint regionend, uint *pagedir, uint *ptmap);
+uint pagerelease(uint regionstart, uint regionend);
+void *kmap(uint frameaddr);
+void kunmap(void *addr);
+syscall pagein(uint addr);
+syscall pageinlarge(uint addr);
+syscall pagesplit(uint addr);
+syscall pagemap(uint addr, uint frameaddr, uint flags);
+uint pagelookup(uint *pagedir, uint addr);
+void pagewalk(uint *pagedir, struct pagestat *stat);
+syscall pageunshare(uint addr);
 void enablepaging(void);
+bool enableglobalpages(void);
+bool enablelargepages(void);
+void disableglobalpages(void);
 void loadCR3(uint *pagedir);
+uint readCR2(void);
+void invlpg(uint addr);
+
+// Page fault handling
+syscall pagefault(uint errcode);
 
 #endif
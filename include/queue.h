@@ -26,10 +26,13 @@
 
 #include <kernel.h>
 
+/** Priority levels in the ready queue, a multiple of 32 */
+#define NPRIO   64
+
 #ifndef NQENT
 
-/** NQENT = 1 per thread, 2 per list, 2 per sem */
-#define NQENT   (NTHREAD + 4 + NSEM + NSEM)
+/** NQENT = 1 per thread, 2 per list, 2 per ready level, 2 per sem */
+#define NQENT   (NTHREAD + 2 + NPRIO + NPRIO + NSEM + NSEM)
 #endif
 
 #define EMPTY (-2)              /**< null pointer for queues            */
@@ -49,7 +52,19 @@ struct queent
 };
 
 extern struct queent quetab[];
+
+/*
+ * The ready queue is NPRIO FIFO queues, one per priority level, allocated
+ * consecutively in quetab starting at readylist.  A bit is set in readymap
+ * for each level which may hold threads; levels emptied by getitem() are
+ * cleared lazily by readyfirst() and readydequeue().  Priorities outside
+ * 0..NPRIO-1 share the nearest level.
+ */
 extern qid_typ readylist;
+extern ulong readymap[NPRIO / 32];
+
+#define prio2level(p)   ((p) < 0 ? 0 : ((p) >= NPRIO ? NPRIO - 1 : (p)))
+#define readyqueue(l)   (readylist + 2 * (l))
 
 #define quehead(q) (q)
 #define quetail(q) ((q) + 1)
@@ -75,5 +90,9 @@ tid_typ dequeue(qid_typ);
 int insert(tid_typ, qid_typ, int);
 int insertd(tid_typ, qid_typ, int);
 qid_typ queinit(void);
+void readyinit(void);
+int readyinsert(tid_typ, int);
+int readyfirst(void);
+tid_typ readydequeue(void);
 
 #endif                          /* _QUEUE_H_ */
@@ -33,6 +33,7 @@ extern struct sement semtab[];
 
 /* Semaphore function prototypes */
 syscall wait(semaphore);
+syscall waittime(semaphore, int);
 syscall signal(semaphore);
 syscall signaln(semaphore, int);
 semaphore semcreate(int);
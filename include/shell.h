@@ -92,6 +92,7 @@ shellcmd xsh_exit(int, char *[]);
 shellcmd xsh_flashstat(int, char *[]);
 shellcmd xsh_gpiostat(int, char *[]);
 shellcmd xsh_help(int, char *[]);
+shellcmd xsh_irqstat(int, char *[]);
 shellcmd xsh_kexec(int, char *[]);
 shellcmd xsh_kill(int, char *[]);
 shellcmd xsh_led(int, char *[]);
@@ -118,6 +119,7 @@ shellcmd xsh_telnetserver(int, char *[]);
 shellcmd xsh_test(int, char *[]);
 shellcmd xsh_testsuite(int, char *[]);
 shellcmd xsh_timeserver(int, char *[]);
+shellcmd xsh_trace(int, char *[]);
 shellcmd xsh_turtle(int, char *[]);
 shellcmd xsh_uartstat(int, char *[]);
 shellcmd xsh_udpstat(int, char *[]);
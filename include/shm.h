@@ -0,0 +1,65 @@
+/**
+ * @file shm.h
+ * Shared memory segments.
+ *
+ * A segment is a run of physical frames which threads map into their own
+ * page directories with shmattach().  Each mapping holds a reference on
+ * every frame of the segment, as does the segment itself until shmfree(),
+ * so the frames are returned only once the last mapping is gone.
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#ifndef _SHM_H_
+#define _SHM_H_
+
+#include <stddef.h>
+#include <conf.h>
+
+#ifndef NSHM
+#  define NSHM 0
+#endif
+
+/** Segments a single thread may have attached at once */
+#define NSHMMAP     4
+
+/* Segment state definitions */
+#define SHMFREE     0x01        /**< this segment is free               */
+#define SHMUSED     0x02        /**< this segment is used               */
+
+/** Key which never matches an existing segment */
+#define SHM_PRIVATE 0
+
+/**
+ * Shared memory segment table entry
+ */
+struct shment
+{
+    char state;                 /**< segment state (SHMFREE or SHMUSED) */
+    int key;                    /**< key the segment was created with   */
+    uint frameaddr;             /**< physical address of first frame    */
+    uint npages;                /**< frames in the segment              */
+};
+
+/**
+ * A segment attached to a thread, kept in its thread table entry
+ */
+struct shmmap
+{
+    uint addr;                  /**< user address of the mapping, or 0  */
+    uint npages;                /**< pages mapped                       */
+    void *reserve;              /**< heap block holding the mapping if
+                                     shmattach() chose the address      */
+};
+
+extern struct shment shmtab[];
+
+/** Determine if a segment is invalid or not in use  */
+#define isbadshm(s) ((s) < 0 || (s) >= NSHM || SHMFREE == shmtab[(s)].state)
+
+/* Shared memory function prototypes */
+int shmget(int, uint);
+void *shmattach(int, void *);
+syscall shmdetach(void *);
+syscall shmfree(int);
+
+#endif                          /* _SHM_H_ */
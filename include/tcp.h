@@ -15,6 +15,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <thread.h>
+#include <timer.h>
 
 /* Tracing macros */
 //#define TRACE_TCP     TTY1
@@ -212,9 +213,7 @@ extern struct tcb tcptab[];
 #define tcpSeglen(tcppkt, len) (len - offset2octets(tcppkt->offset))
 
 /* TCP Timer Constants */
-#define TCP_NEVENTS     (3*NTCP)+1 /**< max number events (incl dummy head) */
-#define TCP_EVT_HEAD    0   /**< Head entry */
-#define TCP_FREQ        10  /**< milliseconds per timer tick */
+#define TCP_NEVENTS     (3*NTCP) /**< max number events */
 #define TCP_EVT_TIMEWT  1   /**< 2MSL time-wait timeout */
 #define TCP_EVT_RXT     2   /**< retransmit event */
 #define TCP_EVT_PERSIST 3   /**< persist event, for zero window */
@@ -234,14 +233,15 @@ extern struct tcb tcptab[];
 struct tcpEvent
 {
     bool used;                      /**< Is timer event record used? */
-    int time;                       /**< number of TCP timer ticks for event */
-    int remain;                     /**< TCP timer ticks remain */
+    bool expired;                   /**< Waiting for tcpTimer to trigger */
+    int time;                       /**< milliseconds until event */
     uchar type;                     /**< Type of event */
     struct tcb *tcbptr;             /**< TCB for event */
-    struct tcpEvent *next;          /**< Next timer event */
+    struct tment timer;             /**< Clock timer for event */
 };
 
 extern struct tcpEvent tcptimertab[];
+extern tid_typ tcptimertid;
 extern semaphore tcpmutex;
 
 /* TCP Control Functions */
@@ -265,6 +265,8 @@ devcall tcpControl(device *, int, long, long);
 ushort tcpAlloc(void);
 ushort tcpChksum(struct packet *, ushort, struct netaddr *,
                  struct netaddr *);
+ushort tcpChksumHdr(struct packet *, ushort, struct netaddr *,
+                    struct netaddr *, ushort, uint);
 devcall tcpFree(struct tcb *);
 int tcpOpenActive(struct tcb *);
 void tcpAbort(struct tcb *, int);
@@ -293,6 +295,7 @@ int tcpSendRst(struct packet *, struct netaddr *, struct netaddr *);
 void tcpStat(struct tcb *);
 
 thread tcpTimer(void);
+void tcpTimerExpire(int);
 void tcpTimerTrigger(uchar, struct tcb *);
 devcall tcpTimerSched(int, struct tcb *, uchar);
 devcall tcpTimerPurge(struct tcb *, uchar);
@@ -45,6 +45,16 @@ thread test_raw(bool);
 thread test_ip(bool);
 thread test_umemory(bool);
 thread test_tlb(bool);
+thread test_framealloc(bool);
+thread test_pagefault(bool);
+thread test_clone(bool);
+thread test_kmap(bool);
+thread test_ctxsw(bool);
+thread test_timer(bool);
+thread test_netChksum(bool);
+thread test_largepage(bool);
+thread test_shm(bool);
+thread test_monitor(bool);
 
 void testPass(bool, const char *);
 void testFail(bool, const char *);
@@ -13,6 +13,9 @@
 #include <debug.h>
 #include <stddef.h>
 #include <memory.h>
+#include <paging.h>
+#include <timer.h>
+#include <shm.h>
 #endif /* __ASSEMBLER__ */
 
 /* unusual value marks the top of the thread stack                      */
@@ -28,6 +31,7 @@
 #define THRWAIT     7           /**< thread is on semaphore queue       */
 #define THRTMOUT    8           /**< thread is receiving with timeout   */
 #define THRMIGRATE  9           /**< thread is being migrated           */
+#define THRMBOX     10          /**< thread is selecting on mailboxes   */
 
 /* miscellaneous thread definitions                                     */
 #define TNMLEN      16          /**< length of thread "name"            */
@@ -38,6 +42,10 @@
 #define INITSTK     65536       /**< initial thread stack size          */
 #define INITPRIO    20          /**< initial thread priority            */
 #define MINSTK      128         /**< minimum thread stack size          */
+#define STKGUARD    4096        /**< unmapped guard below each stack    */
+#define REAPPRIO    1           /**< priority of the idle reaper thread */
+#define NREAP       8           /**< address spaces queued for reaper   */
+#define MSGQLEN     16          /**< most messages a thread can queue   */
 #ifdef JTAG_DEBUG
 #define INITRET   debugret      /**< threads return address for debug   */
 #else                           /* not JTAG_DEBUG */
@@ -72,42 +80,70 @@ struct thrent
 {
     uchar state;                /**< thread state: THRCURR, etc.        */
     int prio;                   /**< thread priority                    */
+    int baseprio;               /**< priority before monitor inheritance */
     void *stkptr;               /**< saved stack pointer                */
     void *stkbase;              /**< base of run time stack             */
     ulong stklen;               /**< stack length in bytes              */
     char name[TNMLEN];          /**< thread name                        */
     irqmask intmask;            /**< saved interrupt mask               */
+    uint csdepth;               /**< saved CS_DISABLE() nesting depth   */
     semaphore sem;              /**< semaphore waiting for              */
+    int monwait;                /**< monitor waiting to lock, or NOMON  */
     tid_typ parent;             /**< tid for the parent thread          */
     message msg;                /**< message sent to this thread        */
-    bool hasmsg;                /**< nonzero iff msg is valid           */
+    bool hasmsg;                /**< nonzero iff a message is waiting   */
+    message msgq[MSGQLEN];      /**< message ring, used if msgqmax > 0  */
+    uint msgqmax;               /**< messages the ring holds, or 0      */
+    uint msgqhead;              /**< index of oldest message in ring    */
+    uint msgqcount;             /**< messages in the ring               */
+    semaphore msgqroom;         /**< free ring slots, for sendwait()    */
+    uint msgdrops;              /**< messages refused for lack of room  */
     struct memblock memlist;    /**< free memory list of thread         */
+    void *slabfree[NSLAB];      /**< free small objects, by size class  */
     int fdesc[NDESC];           /**< device descriptors for thread      */
     uint *pagedir;              /**< pointer to page directory          */
+    uint ptmap[PTMAP_WORDS];    /**< page tables present in pagedir     */
+    uint pgfaults;              /**< page faults resolved on demand     */
+    uint rss;                   /**< user pages backed by frames        */
+    uint stkpeak;               /**< most stack pages ever backed       */
+    uint untrimmed;             /**< bytes freed since last memtrim()   */
+    uint brk;                   /**< end of heap, raised as it grows    */
+    struct shmmap shmmaps[NSHMMAP]; /**< attached shared memory segments */
+    struct tment timer;         /**< sleep and receive timeout timer    */
 };
 
 extern struct thrent thrtab[];
 extern int thrcount;            /**< currently active threads           */
 extern tid_typ thrcurrent;      /**< currently executing thread         */
+extern tid_typ reapertid;       /**< thread freeing dead address spaces */
 
 /* Inter-Thread Communication prototypes */
 syscall send(tid_typ, message);
 message receive(void);
 message recvclr(void);
 message recvtime(int);
+syscall sendwait(tid_typ, message);
+syscall msgqueue(tid_typ, uint);
+void msgdeposit(tid_typ, message);
+message msgtake(struct thrent *);
 
 /* Thread management function prototypes */
 
 tid_typ create(void *procaddr, uint ssize, int priority,
                const char *name, int nargs, ...);
+tid_typ clone(void *procaddr, int priority, const char *name, int nargs, ...);
 tid_typ gettid(void);
 syscall getprio(tid_typ);
 syscall kill(int);
 int ready(tid_typ, bool);
 int resched(void);
+syscall resume(tid_typ);
 syscall sleep(uint);
+syscall suspend(tid_typ);
 syscall unsleep(tid_typ);
 syscall yield(void);
+void reap(uint *, uint *);
+thread reaper(void);
 
 /**
  * @ingroup threads
@@ -0,0 +1,51 @@
+/**
+ * @file timer.h
+ * Hierarchical timer wheel driven by the clock interrupt.
+ *
+ * Timers are kept in TMLEVELS wheels of TMSLOTS slots.  Level 0 holds
+ * timers due within TMSLOTS ticks, one slot per tick; each higher level
+ * covers TMSLOTS times the span of the level below, one slot per turn of
+ * that level.  When a level wraps, the next slot of the level above is
+ * cascaded down.  Setting and cancelling a timer are constant time, and a
+ * tick touches a single slot except when cascading.
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#ifndef _TIMER_H_
+#define _TIMER_H_
+
+#include <stddef.h>
+
+#define TMSLOTBITS  6                   /**< log2 of slots per level    */
+#define TMSLOTS     (1 << TMSLOTBITS)   /**< slots per level            */
+#define TMLEVELS    4                   /**< wheels in the hierarchy    */
+
+/** Longest delay the wheel holds directly; longer timers are recascaded */
+#define TMMAXTICKS  ((1UL << (TMSLOTBITS * TMLEVELS)) - 1)
+
+/**
+ * A timer.  Owners embed these in their own structures; a timer on no
+ * wheel has a NULL next pointer.  The function is called from the clock
+ * interrupt with interrupts disabled, and must not reschedule.
+ */
+struct tment
+{
+    struct tment *next;         /**< next timer in slot                 */
+    struct tment *prev;         /**< previous timer in slot             */
+    ulong expires;              /**< tick on which the timer fires      */
+    void (*func) (int);         /**< function called on expiry          */
+    int arg;                    /**< argument to func                   */
+};
+
+extern volatile ulong tmticks;
+
+void tminit(void);
+void tmset(struct tment *, ulong, void (*)(int), int);
+void tmcancel(struct tment *);
+ulong tmremain(struct tment *);
+void tmtick(void);
+ulong tmnext(ulong);
+
+#define tmpending(tm)   (NULL != (tm)->next)
+
+#endif                          /* _TIMER_H_ */
@@ -0,0 +1,92 @@
+/**
+ * @file trace.h
+ * Kernel tracing into an in-memory ring buffer.
+ *
+ * Each subsystem has a compile-time trace level.  At TRACE_OFF its trace
+ * macro expands to nothing.  At TRACE_RING a record holding the format
+ * string and raw arguments is appended to the ring buffer; formatting is
+ * deferred until the buffer is dumped with the `trace` shell command.  At
+ * TRACE_ECHO the record is also printed synchronously with kprintf(), which
+ * costs milliseconds per line on the polled UART.
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stddef.h>
+
+/* Trace levels */
+#define TRACE_OFF   0           /**< compiled out                       */
+#define TRACE_RING  1           /**< recorded in the ring buffer        */
+#define TRACE_ECHO  2           /**< recorded and printed with kprintf  */
+
+/* Per-subsystem trace levels */
+#ifndef TRACE_SCHED
+#define TRACE_SCHED     TRACE_OFF       /**< resched()                  */
+#endif
+#ifndef TRACE_THREAD
+#define TRACE_THREAD    TRACE_OFF       /**< create() and kill()        */
+#endif
+#ifndef TRACE_PAGING
+#define TRACE_PAGING    TRACE_OFF       /**< paging and page faults     */
+#endif
+#ifndef TRACE_MEM
+#define TRACE_MEM       TRACE_OFF       /**< memget() and memfree()     */
+#endif
+
+#define TRACE_NENTRY    256     /**< records in the ring, power of two  */
+#define TRACE_NARG      4       /**< arguments kept per record          */
+
+/**
+ * A trace record.  Only the format string pointer is kept, so it must be
+ * a string literal; %s arguments must likewise stay valid until dumped.
+ */
+struct tracent
+{
+    ulong seq;                  /**< sequence number, 0 if unused       */
+    ulong tsc;                  /**< time-stamp counter when recorded   */
+    int tid;                    /**< thread running when recorded       */
+    const char *fmt;            /**< printf-style format string         */
+    ulong args[TRACE_NARG];     /**< raw arguments for fmt              */
+};
+
+extern struct tracent tracebuf[TRACE_NENTRY];
+extern ulong tracenext;
+
+void tracelog(bool echo, const char *fmt, ...);
+void tracedump(void);
+void traceclear(void);
+
+/* Expands to nothing unless the level is TRACE_RING or above */
+#define TRACE_AT(level, ...)    { \
+        if ((level) >= TRACE_RING) \
+        { \
+            tracelog((level) >= TRACE_ECHO, __VA_ARGS__); \
+        } }
+
+#if TRACE_SCHED
+#define SCHED_TRACE(...)    TRACE_AT(TRACE_SCHED, __VA_ARGS__)
+#else
+#define SCHED_TRACE(...)
+#endif
+
+#if TRACE_THREAD
+#define THREAD_TRACE(...)   TRACE_AT(TRACE_THREAD, __VA_ARGS__)
+#else
+#define THREAD_TRACE(...)
+#endif
+
+#if TRACE_PAGING
+#define PAGING_TRACE(...)   TRACE_AT(TRACE_PAGING, __VA_ARGS__)
+#else
+#define PAGING_TRACE(...)
+#endif
+
+#if TRACE_MEM
+#define MEM_TRACE(...)      TRACE_AT(TRACE_MEM, __VA_ARGS__)
+#else
+#define MEM_TRACE(...)
+#endif
+
+#endif                          /* _TRACE_H_ */
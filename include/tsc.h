@@ -0,0 +1,23 @@
+/**
+ * @file tsc.h
+ * Access to the x86 time-stamp counter for cycle-level measurements.
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#ifndef _TSC_H_
+#define _TSC_H_
+
+#include <stddef.h>
+
+/**
+ * Read the low word of the time-stamp counter.  Only differences between
+ * two reads are meaningful, and intervals longer than 2^32 cycles wrap.
+ */
+static inline ulong rdtsc(void)
+{
+    ulong lo, hi;
+    __asm__ __volatile__("rdtsc":"=a"(lo), "=d"(hi));
+    return lo;
+}
+
+#endif                          /* _TSC_H_ */
@@ -155,6 +155,8 @@ devcall udpWrite(device *, const void *, uint);
 ushort udpAlloc(void);
 ushort udpChksum(struct packet *, ushort, const struct netaddr *,
                  const struct netaddr *);
+ushort udpChksumHdr(struct packet *, ushort, const struct netaddr *,
+                    const struct netaddr *, ushort, uint);
 struct udp *udpDemux(ushort, ushort, const struct netaddr *,
                      const struct netaddr *);
 syscall udpRecv(struct packet *, const struct netaddr *,
@@ -11,6 +11,10 @@
  * Copy the specified number of bytes of memory to another location.  The memory
  * locations must not overlap.
  *
+ * When the source and destination are equally aligned the bulk of the copy is
+ * done a word at a time.  Architectures with faster block-copy instructions
+ * replace this file; see the libxc Makefile.
+ *
  * @param dest
  *      Pointer to the destination memory.
  * @param src
@@ -25,11 +29,42 @@ void *memcpy(void *dest, const void *src, size_t n)
 {
     unsigned char *dest_p = dest;
     const unsigned char *src_p = src;
-    size_t i;
+    ulong *dest_w;
+    const ulong *src_w;
+
+    if (0 == (((ulong)dest_p ^ (ulong)src_p) & (sizeof(ulong) - 1)))
+    {
+        while ((n > 0) && ((ulong)dest_p & (sizeof(ulong) - 1)))
+        {
+            *dest_p++ = *src_p++;
+            n--;
+        }
+
+        dest_w = (ulong *)dest_p;
+        src_w = (const ulong *)src_p;
+        while (n >= 4 * sizeof(ulong))
+        {
+            dest_w[0] = src_w[0];
+            dest_w[1] = src_w[1];
+            dest_w[2] = src_w[2];
+            dest_w[3] = src_w[3];
+            dest_w += 4;
+            src_w += 4;
+            n -= 4 * sizeof(ulong);
+        }
+        while (n >= sizeof(ulong))
+        {
+            *dest_w++ = *src_w++;
+            n -= sizeof(ulong);
+        }
+        dest_p = (unsigned char *)dest_w;
+        src_p = (const unsigned char *)src_w;
+    }
 
-    for (i = 0; i < n; i++)
+    while (n > 0)
     {
-        dest_p[i] = src_p[i];
+        *dest_p++ = *src_p++;
+        n--;
     }
 
     return dest;
@@ -0,0 +1,66 @@
+/**
+ * @file memmove.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <string.h>
+
+/**
+ * @ingroup libxc
+ *
+ * Copy the specified number of bytes of memory to another location.  Unlike
+ * memcpy(), the memory locations may overlap.
+ *
+ * @param dest
+ *      Pointer to the destination memory.
+ * @param src
+ *      Pointer to the source memory.
+ * @param n
+ *      The amount of data (in bytes) to copy.
+ *
+ * @return
+ *      @p dest
+ */
+void *memmove(void *dest, const void *src, size_t n)
+{
+    unsigned char *dest_p = dest;
+    const unsigned char *src_p = src;
+    ulong *dest_w;
+    const ulong *src_w;
+
+    /* A forward copy is safe unless dest lies inside the source */
+    if ((ulong)dest_p - (ulong)src_p >= n)
+    {
+        return memcpy(dest, src, n);
+    }
+
+    /* Copy backwards from the end */
+    dest_p += n;
+    src_p += n;
+    if (0 == (((ulong)dest_p ^ (ulong)src_p) & (sizeof(ulong) - 1)))
+    {
+        while ((n > 0) && ((ulong)dest_p & (sizeof(ulong) - 1)))
+        {
+            *--dest_p = *--src_p;
+            n--;
+        }
+
+        dest_w = (ulong *)dest_p;
+        src_w = (const ulong *)src_p;
+        while (n >= sizeof(ulong))
+        {
+            *--dest_w = *--src_w;
+            n -= sizeof(ulong);
+        }
+        dest_p = (unsigned char *)dest_w;
+        src_p = (const unsigned char *)src_w;
+    }
+
+    while (n > 0)
+    {
+        *--dest_p = *--src_p;
+        n--;
+    }
+
+    return dest;
+}
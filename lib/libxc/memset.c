@@ -10,6 +10,10 @@
  *
  * Fills a region of memory with a byte.
  *
+ * The aligned middle of the region is filled a word at a time.
+ * Architectures with faster block-fill instructions replace this file; see
+ * the libxc Makefile.
+ *
  * @param s
  *      pointer to the memory to place byte into
  * @param c
@@ -24,11 +28,39 @@ void *memset(void *s, int c, size_t n)
 {
     unsigned char *p = s;
     unsigned char byte = c;
-    size_t i;
+    ulong word, *p_w;
+
+    while ((n > 0) && ((ulong)p & (sizeof(ulong) - 1)))
+    {
+        *p++ = byte;
+        n--;
+    }
+
+    /* Replicate the byte into every byte of a word */
+    word = byte;
+    word |= word << 8;
+    word |= word << 16;
+    p_w = (ulong *)p;
+    while (n >= 4 * sizeof(ulong))
+    {
+        p_w[0] = word;
+        p_w[1] = word;
+        p_w[2] = word;
+        p_w[3] = word;
+        p_w += 4;
+        n -= 4 * sizeof(ulong);
+    }
+    while (n >= sizeof(ulong))
+    {
+        *p_w++ = word;
+        n -= sizeof(ulong);
+    }
+    p = (unsigned char *)p_w;
 
-    for (i = 0; i < n; i++)
+    while (n > 0)
     {
-        p[i] = byte;
+        *p++ = byte;
+        n--;
     }
     return s;
 }
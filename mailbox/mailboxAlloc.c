@@ -4,7 +4,10 @@
 /* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
 
 #include <mailbox.h>
-#include <memory.h>
+
+/* Message rings.  Each thread has a heap of its own, so a ring taken from
+ * the allocating thread's heap could not be reached by other threads. */
+static int mboxrings[NMAILBOX][MAILBOX_MAXINTS];
 
 /**
  * @ingroup mailbox
@@ -20,12 +23,40 @@
  *      are already in use or other resources could not be allocated.
  */
 syscall mailboxAlloc(uint count)
+{
+    return mailboxAllocWords(count, 1);
+}
+
+/**
+ * @ingroup mailbox
+ *
+ * Allocate a mailbox whose messages are each a fixed number of ints.  Such
+ * mailboxes are used with mailboxSendBatch() and mailboxReceiveBatch(),
+ * which copy whole messages; mailboxSend() and mailboxReceive() only work
+ * on mailboxes of single int messages.
+ *
+ * @param count
+ *      Maximum number of messages allowed for the mailbox.
+ * @param words
+ *      Number of ints in each message.
+ *
+ * @return
+ *      The index of the newly allocated mailbox, or ::SYSERR if all mailboxes
+ *      are already in use, @p count times @p words is more than
+ *      ::MAILBOX_MAXINTS, or other resources could not be allocated.
+ */
+syscall mailboxAllocWords(uint count, uint words)
 {
     static uint nextmbx = 0;
     uint i;
     struct mbox *mbxptr;
     int retval = SYSERR;
 
+    if ((0 == words) || (0 == count) || (count > MAILBOX_MAXINTS / words))
+    {
+        return SYSERR;
+    }
+
     /* wait until other threads are done editing the mailbox table */
     wait(mboxtabsem);
 
@@ -38,25 +69,20 @@ syscall mailboxAlloc(uint count)
         /* when we find a free mailbox set that one up and return it */
         if (MAILBOX_FREE == mbxptr->state)
         {
-            /* get memory space for the message queue */
-            mbxptr->msgs = memget(sizeof(int) * count);
-
-            /* check if memory was allocated correctly */
-            if (SYSERR == (int)mbxptr->msgs)
-            {
-                break;
-            }
+            /* the message queue is this mailbox's ring */
+            mbxptr->msgs = mboxrings[nextmbx];
 
             /* initialize mailbox details and semaphores */
             mbxptr->count = 0;
             mbxptr->start = 0;
             mbxptr->max = count;
+            mbxptr->words = words;
+            mbxptr->selector = BADTID;
             mbxptr->sender = semcreate(count);
             mbxptr->receiver = semcreate(0);
             if ((SYSERR == (int)mbxptr->sender) ||
                 (SYSERR == (int)mbxptr->receiver))
             {
-                memfree(mbxptr->msgs, sizeof(int) * (mbxptr->max));
                 semfree(mbxptr->sender);
                 semfree(mbxptr->receiver);
                 break;
@@ -5,6 +5,7 @@
 
 #include <interrupt.h>
 #include <mailbox.h>
+#include <critical.h>
 
 /**
  * @ingroup mailbox
@@ -31,7 +32,7 @@ syscall mailboxCount(mailbox box)
     }
 
     mbxptr = &mboxtab[box];
-    im = disable();
+    im = CS_DISABLE();
     if (MAILBOX_ALLOC == mbxptr->state)
     {
         retval = mbxptr->count;
@@ -40,6 +41,6 @@ syscall mailboxCount(mailbox box)
     {
         retval = SYSERR;
     }
-    restore(im);
+    CS_RESTORE(im);
     return retval;
 }
@@ -4,7 +4,6 @@
 /* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
 
 #include <mailbox.h>
-#include <memory.h>
 
 /**
  * @ingroup mailbox
@@ -35,16 +34,15 @@ syscall mailboxFree(mailbox box)
 
     if (MAILBOX_ALLOC == mbxptr->state)
     {
-        /* mark mailbox as no longer allocated  */
+        /* mark mailbox as no longer allocated, which a selecting thread
+         * finds when it wakes */
         mbxptr->state = MAILBOX_FREE;
+        mailboxNotify(box);
 
         /* free semaphores related to this mailbox */
         semfree(mbxptr->sender);
         semfree(mbxptr->receiver);
 
-        /* free memory that was used for the message queue */
-        memfree(mbxptr->msgs, sizeof(int) * (mbxptr->max));
-
         retval = OK;
     }
     else
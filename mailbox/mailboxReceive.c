@@ -5,6 +5,7 @@
 
 #include <interrupt.h>
 #include <mailbox.h>
+#include <critical.h>
 
 /**
  * @ingroup mailbox
@@ -16,8 +17,8 @@
  *
  * @return
  *      On success, returns the message that was dequeued; on failure (@p box
- *      did not specify an allocated mailbox, or the mailbox was freed while
- *      waiting for a message) returns ::SYSERR.  Note that it may be impossible
+ *      did not specify an allocated mailbox of single int messages, or the
+ *      mailbox was freed while waiting for a message) returns ::SYSERR.  Note that it may be impossible
  *      to disambiguate ::SYSERR from a successful return value.
  */
 syscall mailboxReceive(mailbox box)
@@ -32,9 +33,9 @@ syscall mailboxReceive(mailbox box)
     }
 
     mbxptr = &mboxtab[box];
-    im = disable();
+    im = CS_DISABLE();
     retval = SYSERR;
-    if (MAILBOX_ALLOC == mbxptr->state)
+    if ((MAILBOX_ALLOC == mbxptr->state) && (1 == mbxptr->words))
     {
         /* wait until there is a mailmsg in the mailmsg queue */
         wait(mbxptr->receiver);
@@ -53,6 +54,6 @@ syscall mailboxReceive(mailbox box)
         }
     }
 
-    restore(im);
+    CS_RESTORE(im);
     return retval;
 }
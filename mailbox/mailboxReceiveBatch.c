@@ -0,0 +1,83 @@
+/**
+ * @file mailboxReceiveBatch.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <mailbox.h>
+#include <critical.h>
+
+/**
+ * @ingroup mailbox
+ *
+ * Receive several messages from the specified mailbox at once.
+ *
+ * This waits until there is at least one message, then takes up to @p nmsgs
+ * of those queued without waiting again, and wakes senders for all the room
+ * freed with one signaln().
+ *
+ * @param box
+ *      The index of the mailbox to receive the messages from.
+ * @param msgs
+ *      Buffer for the messages, each the mailbox's number of ints.
+ * @param nmsgs
+ *      The number of messages @p msgs can hold, which must be positive.
+ *
+ * @return
+ *      The number of messages received, between 1 and @p nmsgs, or ::SYSERR
+ *      if @p box did not specify a valid allocated mailbox or if the mailbox
+ *      was freed while waiting for a message.
+ */
+syscall mailboxReceiveBatch(mailbox box, int *msgs, uint nmsgs)
+{
+    struct mbox *mbxptr;
+    struct sement *semptr;
+    irqmask im;
+    uint n, got, i, slot;
+    int retval;
+
+    if (!(0 <= box && box < NMAILBOX) || (0 == nmsgs))
+    {
+        return SYSERR;
+    }
+
+    mbxptr = &mboxtab[box];
+    im = CS_DISABLE();
+    retval = SYSERR;
+    if (MAILBOX_ALLOC == mbxptr->state)
+    {
+        /* wait until there is at least one message in the queue */
+        wait(mbxptr->receiver);
+
+        /* only continue if the mailbox hasn't been freed  */
+        if (MAILBOX_ALLOC == mbxptr->state)
+        {
+            /* claim any further messages without blocking */
+            semptr = &semtab[mbxptr->receiver];
+            for (n = 1; (n < nmsgs) && (semptr->count > 0); n++)
+            {
+                semptr->count--;
+            }
+
+            /* copy the messages from the head of the queue */
+            for (got = 0; got < n; got++)
+            {
+                slot = mbxptr->start;
+                for (i = 0; i < mbxptr->words; i++)
+                {
+                    *msgs++ = mbxptr->msgs[slot * mbxptr->words + i];
+                }
+                mbxptr->start = (mbxptr->start + 1) % mbxptr->max;
+                mbxptr->count--;
+            }
+
+            /* signal that there is more empty space in the queue */
+            signaln(mbxptr->sender, n);
+            retval = n;
+        }
+    }
+
+    CS_RESTORE(im);
+    return retval;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file mailboxReceiveTime.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <mailbox.h>
+#include <critical.h>
+
+/**
+ * @ingroup mailbox
+ *
+ * Receive a message from the specified mailbox, waiting no longer than the
+ * given time for one to arrive.  The wait is made on the mailbox's receiver
+ * semaphore with waittime(), so timed receivers queue for messages along
+ * with mailboxReceive() callers, and are timed by the thread's timer like
+ * recvtime().
+ *
+ * @param box
+ *      The index of the mailbox to receive the message from.
+ * @param maxwait
+ *      Ticks to wait for a message before timing out.
+ *
+ * @return
+ *      On success, returns the message that was dequeued.  Returns ::TIMEOUT
+ *      if no message arrived in time, and ::SYSERR if @p box did not specify
+ *      an allocated mailbox of single int messages, the mailbox was freed
+ *      while waiting, or @p maxwait was negative.  As with mailboxReceive(),
+ *      these may be impossible to tell apart from messages.
+ */
+syscall mailboxReceiveTime(mailbox box, int maxwait)
+{
+    struct mbox *mbxptr;
+    irqmask im;
+    int retval;
+
+    if (!(0 <= box && box < NMAILBOX) || (maxwait < 0))
+    {
+        return SYSERR;
+    }
+
+    mbxptr = &mboxtab[box];
+    im = CS_DISABLE();
+    retval = SYSERR;
+    if ((MAILBOX_ALLOC == mbxptr->state) && (1 == mbxptr->words))
+    {
+        /* wait until there is a message or time runs out */
+        retval = waittime(mbxptr->receiver, maxwait);
+
+        /* only continue if the mailbox hasn't been freed  */
+        if ((OK == retval) && (MAILBOX_ALLOC == mbxptr->state))
+        {
+            retval = mbxptr->msgs[mbxptr->start];
+
+            mbxptr->start = (mbxptr->start + 1) % mbxptr->max;
+            mbxptr->count--;
+
+            /* signal that there is another empty space in the queue */
+            signal(mbxptr->sender);
+        }
+        else if (OK == retval)
+        {
+            retval = SYSERR;
+        }
+    }
+
+    CS_RESTORE(im);
+    return retval;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file mailboxSelect.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <mailbox.h>
+#include <timer.h>
+#include <critical.h>
+
+/**
+ * @ingroup mailbox
+ *
+ * Wait until any of several mailboxes holds a message.
+ *
+ * No message is taken; the caller receives from the mailbox returned, with
+ * mailboxTryReceive() if other threads may be receiving from it too.  This
+ * lets a single thread serve several mailboxes, such as the queues of the
+ * network daemons.  Only one thread at a time may select on a mailbox.
+ *
+ * @param boxes
+ *      The mailboxes to wait on.
+ * @param nboxes
+ *      The number of mailboxes in @p boxes.
+ * @param maxwait
+ *      Ticks to wait before timing out, or a negative value to wait for as
+ *      long as it takes.
+ *
+ * @return
+ *      The first mailbox in @p boxes holding a message; ::TIMEOUT if none
+ *      did before @p maxwait ran out; or ::SYSERR if any of @p boxes did
+ *      not specify an allocated mailbox, was freed while waiting, or
+ *      already has another thread selecting on it.
+ */
+syscall mailboxSelect(const mailbox *boxes, uint nboxes, int maxwait)
+{
+    struct thrent *thrptr;
+    struct mbox *mbxptr;
+    irqmask im;
+    ulong deadline;
+    uint i;
+    int retval;
+
+    if (0 == nboxes)
+    {
+        return SYSERR;
+    }
+    for (i = 0; i < nboxes; i++)
+    {
+        if (!(0 <= boxes[i] && boxes[i] < NMAILBOX))
+        {
+            return SYSERR;
+        }
+    }
+
+    im = CS_DISABLE();
+    /* a mailbox holds a single selector, which must not be taken over */
+    for (i = 0; i < nboxes; i++)
+    {
+        tid_typ selector = mboxtab[boxes[i]].selector;
+        if (!isbadtid(selector) && (thrcurrent != selector))
+        {
+            CS_RESTORE(im);
+            return SYSERR;
+        }
+    }
+    thrptr = &thrtab[thrcurrent];
+    deadline = tmticks + maxwait;
+    retval = TIMEOUT;
+    for (;;)
+    {
+        for (i = 0; i < nboxes; i++)
+        {
+            mbxptr = &mboxtab[boxes[i]];
+            if (MAILBOX_ALLOC != mbxptr->state)
+            {
+                retval = SYSERR;
+                break;
+            }
+            if (semtab[mbxptr->receiver].count > 0)
+            {
+                retval = boxes[i];
+                break;
+            }
+        }
+        if ((i < nboxes)
+            || ((maxwait >= 0) && ((long)(deadline - tmticks) <= 0)))
+        {
+            break;
+        }
+
+        /* sleep until a sender or the timer wakes us, then look again */
+        for (i = 0; i < nboxes; i++)
+        {
+            mboxtab[boxes[i]].selector = thrcurrent;
+        }
+        if (maxwait >= 0)
+        {
+#if RTCLOCK
+            tmset(&thrptr->timer, deadline - tmticks, wakeup, thrcurrent);
+#else
+            retval = SYSERR;
+            break;
+#endif
+        }
+        thrptr->state = THRMBOX;
+        resched();
+    }
+
+    for (i = 0; i < nboxes; i++)
+    {
+        if (thrcurrent == mboxtab[boxes[i]].selector)
+        {
+            mboxtab[boxes[i]].selector = BADTID;
+        }
+    }
+    CS_RESTORE(im);
+    return retval;
+}
+
+/**
+ * @ingroup mailbox
+ *
+ * Wake the thread selecting on a mailbox, if there is one.  Called when a
+ * message is added to the mailbox or it is freed.
+ *
+ * @param box
+ *      The index of the mailbox which changed.
+ */
+void mailboxNotify(mailbox box)
+{
+    tid_typ tid;
+    irqmask im;
+
+    im = CS_DISABLE();
+    tid = mboxtab[box].selector;
+    if (!isbadtid(tid) && (THRMBOX == thrtab[tid].state))
+    {
+        unsleep(tid);
+        ready(tid, RESCHED_NO);
+    }
+    CS_RESTORE(im);
+}
+
+/**
+ * @ingroup mailbox
+ *
+ * Release the mailboxes a thread is selecting on, so a thread killed in
+ * mailboxSelect() does not keep others from selecting on them.
+ * Interrupts must be disabled.
+ *
+ * @param tid
+ *      The thread giving up its mailboxes.
+ */
+void mailboxUnselect(tid_typ tid)
+{
+    uint i;
+
+    for (i = 0; i < NMAILBOX; i++)
+    {
+        if (tid == mboxtab[i].selector)
+        {
+            mboxtab[i].selector = BADTID;
+        }
+    }
+}
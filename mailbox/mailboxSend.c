@@ -6,6 +6,7 @@
 #include <stddef.h>
 #include <interrupt.h>
 #include <mailbox.h>
+#include <critical.h>
 
 /**
  * @ingroup mailbox
@@ -20,8 +21,8 @@
  *
  * @return ::OK if the message was successfully enqueued, otherwise ::SYSERR.
  *         ::SYSERR is returned only if @p box did not specify a valid allocated
- *         mailbox or if the mailbox was freed while waiting for room in the
- *         queue.
+ *         mailbox of single int messages or if the mailbox was freed while
+ *         waiting for room in the queue.
  */
 syscall mailboxSend(mailbox box, int mailmsg)
 {
@@ -35,9 +36,9 @@ syscall mailboxSend(mailbox box, int mailmsg)
     }
 
     mbxptr = &mboxtab[box];
-    im = disable();
+    im = CS_DISABLE();
     retval = SYSERR;
-    if (MAILBOX_ALLOC == mbxptr->state)
+    if ((MAILBOX_ALLOC == mbxptr->state) && (1 == mbxptr->words))
     {
         /* wait until there is room in the mailmsg queue */
         wait(mbxptr->sender);
@@ -49,6 +50,7 @@ syscall mailboxSend(mailbox box, int mailmsg)
             mbxptr->msgs[((mbxptr->start + mbxptr->count) % mbxptr->max)] =
                 mailmsg;
             mbxptr->count++;
+            mailboxNotify(box);
 
             /* signal that there is another mailmsg in the mailmsg queue */
             signal(mbxptr->receiver);
@@ -57,6 +59,6 @@ syscall mailboxSend(mailbox box, int mailmsg)
         }
     }
 
-    restore(im);
+    CS_RESTORE(im);
     return retval;
 }
@@ -0,0 +1,86 @@
+/**
+ * @file mailboxSendBatch.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <mailbox.h>
+#include <critical.h>
+
+/**
+ * @ingroup mailbox
+ *
+ * Send several messages to the specified mailbox at once.
+ *
+ * This waits until there is room for at least one message, then takes as
+ * much of the remaining room as it needs without waiting again, and wakes
+ * receivers for all the messages with one signaln().  A producer with
+ * messages queued up pays for the interrupt masking, semaphore operations
+ * and reschedule once per batch rather than once per message.
+ *
+ * @param box
+ *      The index of the mailbox to send the messages to.
+ * @param msgs
+ *      The messages to send, each the mailbox's number of ints.
+ * @param nmsgs
+ *      The number of messages in @p msgs, which must be positive.
+ *
+ * @return
+ *      The number of messages sent, between 1 and @p nmsgs, or ::SYSERR if
+ *      @p box did not specify a valid allocated mailbox or if the mailbox was
+ *      freed while waiting for room in the queue.
+ */
+syscall mailboxSendBatch(mailbox box, const int *msgs, uint nmsgs)
+{
+    struct mbox *mbxptr;
+    struct sement *semptr;
+    irqmask im;
+    uint n, sent, i, slot;
+    int retval;
+
+    if (!(0 <= box && box < NMAILBOX) || (0 == nmsgs))
+    {
+        return SYSERR;
+    }
+
+    mbxptr = &mboxtab[box];
+    im = CS_DISABLE();
+    retval = SYSERR;
+    if (MAILBOX_ALLOC == mbxptr->state)
+    {
+        /* wait until there is room for at least one message */
+        wait(mbxptr->sender);
+
+        /* only continue if the mailbox hasn't been freed  */
+        if (MAILBOX_ALLOC == mbxptr->state)
+        {
+            /* claim any further room without blocking */
+            semptr = &semtab[mbxptr->sender];
+            for (n = 1; (n < nmsgs) && (semptr->count > 0); n++)
+            {
+                semptr->count--;
+            }
+
+            /* copy the messages to the tail of the queue */
+            for (sent = 0; sent < n; sent++)
+            {
+                slot = (mbxptr->start + mbxptr->count) % mbxptr->max;
+                for (i = 0; i < mbxptr->words; i++)
+                {
+                    mbxptr->msgs[slot * mbxptr->words + i] = *msgs++;
+                }
+                mbxptr->count++;
+            }
+
+            mailboxNotify(box);
+
+            /* signal that there are more messages in the queue */
+            signaln(mbxptr->receiver, n);
+            retval = n;
+        }
+    }
+
+    CS_RESTORE(im);
+    return retval;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file mailboxTryReceive.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <mailbox.h>
+#include <critical.h>
+
+/**
+ * @ingroup mailbox
+ *
+ * Receive a message from the specified mailbox if one is waiting, without
+ * blocking.
+ *
+ * @param box
+ *      The index of the mailbox to receive the message from.
+ *
+ * @return
+ *      On success, returns the message that was dequeued.  Returns ::TIMEOUT
+ *      if the mailbox is empty, and ::SYSERR if @p box did not specify an
+ *      allocated mailbox of single int messages.  As with mailboxReceive(),
+ *      these may be impossible to tell apart from messages.
+ */
+syscall mailboxTryReceive(mailbox box)
+{
+    struct mbox *mbxptr;
+    irqmask im;
+    int retval;
+
+    if (!(0 <= box && box < NMAILBOX))
+    {
+        return SYSERR;
+    }
+
+    mbxptr = &mboxtab[box];
+    im = CS_DISABLE();
+    retval = SYSERR;
+    if ((MAILBOX_ALLOC == mbxptr->state) && (1 == mbxptr->words))
+    {
+        /* messages not already claimed by a waiting receiver */
+        if (semtab[mbxptr->receiver].count > 0)
+        {
+            retval = mailboxReceive(box);
+        }
+        else
+        {
+            retval = TIMEOUT;
+        }
+    }
+
+    CS_RESTORE(im);
+    return retval;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file mailboxTrySend.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <mailbox.h>
+#include <critical.h>
+
+/**
+ * @ingroup mailbox
+ *
+ * Send a message to the specified mailbox if it has room, without blocking.
+ *
+ * @param box
+ *      The index of the mailbox to send the message to.
+ *
+ * @param mailmsg
+ *      The message to send.
+ *
+ * @return ::OK if the message was enqueued, ::TIMEOUT if the mailbox is full,
+ *         or ::SYSERR if @p box did not specify a valid allocated mailbox of
+ *         single int messages.
+ */
+syscall mailboxTrySend(mailbox box, int mailmsg)
+{
+    struct mbox *mbxptr;
+    irqmask im;
+    int retval;
+
+    if (!(0 <= box && box < NMAILBOX))
+    {
+        return SYSERR;
+    }
+
+    mbxptr = &mboxtab[box];
+    im = CS_DISABLE();
+    retval = SYSERR;
+    if ((MAILBOX_ALLOC == mbxptr->state) && (1 == mbxptr->words))
+    {
+        /* room not already claimed by a waiting sender */
+        if (semtab[mbxptr->sender].count > 0)
+        {
+            retval = mailboxSend(box, mailmsg);
+        }
+        else
+        {
+            retval = TIMEOUT;
+        }
+    }
+
+    CS_RESTORE(im);
+    return retval;
+}
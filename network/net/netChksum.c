@@ -5,33 +5,158 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <stddef.h>
+#include <string.h>
 #include <network.h>
 
+/* Fold a 64-bit one's complement accumulator into 16 bits */
+static uint fold(unsigned long long acc)
+{
+    acc = (acc >> 32) + (acc & 0xFFFFFFFF);
+    acc = (acc >> 32) + (acc & 0xFFFFFFFF);
+    acc = (acc >> 16) + (acc & 0xFFFF);
+    acc = (acc >> 16) + (acc & 0xFFFF);
+    return (uint)acc;
+}
+
 /**
  * @ingroup network
+ *
+ * Add a block of data to a partial Internet checksum.  Words are added 32
+ * bits at a time into a 64-bit accumulator, so carries are folded only once
+ * at the end; the one's complement sum does not depend on word size or byte
+ * order.  The data must be 16-bit aligned.  Blocks may be summed separately
+ * and the partial sums added, provided every block but the last has an even
+ * length.
+ * @param sum  partial sum of preceding data, or 0
+ * @param data data to add
+ * @param len  length of data in bytes
+ * @return partial sum, at most 0xFFFF
  */
-ushort netChksum(void *data, uint len)
+uint netChksumAdd(uint sum, const void *data, uint len)
 {
-    uint sum;
-    ushort *ptr;
+    unsigned long long acc = sum;
+    const ulong *ptr;
 
-    /* Add data to sum */
-    ptr = (ushort *)data;
-    sum = 0;
-    while (len > 1)
+    /* Align to a 32-bit boundary */
+    if ((len > 1) && ((ulong)data & 2))
     {
-        sum += *ptr;
-        ptr++;
+        acc += *(const ushort *)data;
+        data = (const uchar *)data + 2;
+        len -= 2;
+    }
+
+    ptr = data;
+    while (len >= 16)
+    {
+        acc += ptr[0];
+        acc += ptr[1];
+        acc += ptr[2];
+        acc += ptr[3];
+        ptr += 4;
+        len -= 16;
+    }
+    while (len >= 4)
+    {
+        acc += *ptr++;
+        len -= 4;
+    }
+    data = ptr;
+
+    if (len > 1)
+    {
+        acc += *(const ushort *)data;
+        data = (const uchar *)data + 2;
         len -= 2;
     }
 
     /* Add left-over byte, if any */
     if (len > 0)
     {
-        sum += net2hs(*((uchar *)ptr) << 8);
+        acc += net2hs(*((const uchar *)data) << 8);
+    }
+
+    return fold(acc);
+}
+
+/**
+ * @ingroup network
+ *
+ * Copy a block of data and return its partial Internet checksum, reading
+ * the data only once.  If the source and destination are not equally
+ * aligned the block is copied with memcpy() and then whichever copy is
+ * 16-bit aligned is summed.
+ * @param dest destination
+ * @param src  source
+ * @param len  length of data in bytes
+ * @return partial sum of the data, at most 0xFFFF, for netChksumAdd()
+ *      or netChksumFold()
+ */
+uint netChksumCopy(void *dest, const void *src, uint len)
+{
+    unsigned long long acc = 0;
+    ulong *dest_w;
+    const ulong *src_w;
+    ulong w0, w1, w2, w3;
+    ushort h;
+
+    if ((((ulong)dest ^ (ulong)src) & 3) || ((ulong)src & 1))
+    {
+        memcpy(dest, src, len);
+        return netChksumAdd(0, ((ulong)src & 1) ? dest : src, len);
     }
 
-    /* Fold 32-bit sum into 16 bits */
+    if ((len > 1) && ((ulong)src & 2))
+    {
+        h = *(const ushort *)src;
+        *(ushort *)dest = h;
+        acc += h;
+        src = (const uchar *)src + 2;
+        dest = (uchar *)dest + 2;
+        len -= 2;
+    }
+
+    dest_w = dest;
+    src_w = src;
+    while (len >= 16)
+    {
+        w0 = src_w[0];
+        w1 = src_w[1];
+        w2 = src_w[2];
+        w3 = src_w[3];
+        dest_w[0] = w0;
+        dest_w[1] = w1;
+        dest_w[2] = w2;
+        dest_w[3] = w3;
+        acc += w0;
+        acc += w1;
+        acc += w2;
+        acc += w3;
+        dest_w += 4;
+        src_w += 4;
+        len -= 16;
+    }
+    while (len >= 4)
+    {
+        w0 = *src_w++;
+        *dest_w++ = w0;
+        acc += w0;
+        len -= 4;
+    }
+
+    /* Copy and sum the remaining bytes */
+    memcpy(dest_w, src_w, len);
+    return netChksumAdd(fold(acc), dest_w, len);
+}
+
+/**
+ * @ingroup network
+ *
+ * Finish a partial Internet checksum.
+ * @param sum partial sum from netChksumAdd() or netChksumCopy()
+ * @return the checksum, in network order
+ */
+ushort netChksumFold(uint sum)
+{
     while (sum >> 16)
     {
         sum = (sum >> 16) + (sum & 0xFFFF);
@@ -39,3 +164,16 @@ ushort netChksum(void *data, uint len)
 
     return (~sum);
 }
+
+/**
+ * @ingroup network
+ *
+ * Compute the Internet checksum of a block of data.
+ * @param data data to checksum, 16-bit aligned
+ * @param len  length of data in bytes
+ * @return the checksum, in network order
+ */
+ushort netChksum(void *data, uint len)
+{
+    return netChksumFold(netChksumAdd(0, data, len));
+}
@@ -17,8 +17,8 @@
  */
 int snoopClose(struct snoop *cap)
 {
-    struct packet *pkt;
-    int i;
+    struct packet *pkts[SNOOP_QLEN];
+    int i, n;
     irqmask im;
 
     /* Error check pointers */
@@ -40,13 +40,16 @@ int snoopClose(struct snoop *cap)
 #endif
     restore(im);
 
-    /* Free queued packets */
+    /* Free queued packets, as many as are waiting at a time */
     while (mailboxCount(cap->queue) > 0)
     {
-        pkt = (struct packet *)mailboxReceive(cap->queue);
-        if (SYSERR == netFreebuf(pkt))
+        n = mailboxReceiveBatch(cap->queue, (int *)pkts, SNOOP_QLEN);
+        for (i = 0; i < n; i++)
         {
-            return SYSERR;
+            if (SYSERR == netFreebuf(pkts[i]))
+            {
+                return SYSERR;
+            }
         }
     }
 
@@ -39,6 +39,7 @@ const struct centry commandtab[] = {
     {"gpiostat", FALSE, xsh_gpiostat},
 #endif
     {"help", FALSE, xsh_help},
+    {"irqstat", FALSE, xsh_irqstat},
 #if defined(ETH0) || defined(_XINU_PLATFORM_ARM_RPI_)
     {"kexec", FALSE, xsh_kexec},
 #endif
@@ -92,6 +93,7 @@ const struct centry commandtab[] = {
 #if NETHER
     {"timeserver", FALSE, xsh_timeserver},
 #endif
+    {"trace", FALSE, xsh_trace},
 #if FRAMEBUF
     {"turtle", FALSE, xsh_turtle},
 #endif
@@ -125,12 +127,12 @@ extern ulong foreground;
  */
 thread shell(int indescrp, int outdescrp, int errdescrp)
 {
-  kprintf("STARTING SHELL SHIT BABY\n");
     char buf[SHELL_BUFLEN];     /* line input buffer        */
     short buflen;               /* length of line input     */
     char tokbuf[SHELL_BUFLEN + SHELL_MAXTOK];   /* token value buffer       */
     short ntok;                 /* number of tokens         */
     char *tok[SHELL_MAXTOK];    /* pointers to token values */
+    char **cmdtok;              /* heap copy of tokens for child */
     char *outname;              /* name of output file      */
     char *inname;               /* name of input file       */
     bool background;            /* is background proccess?  */
@@ -354,11 +356,26 @@ thread shell(int indescrp, int outdescrp, int errdescrp)
             continue;
         }
 
+        /* Copy tokens to the heap, which the child shares with us */
+        cmdtok = (char **)memget(sizeof(tok) + sizeof(tokbuf));
+        if (SYSERR == (int)cmdtok)
+        {
+            fprintf(stderr, SHELL_CHILDERR);
+            continue;
+        }
+        memcpy(cmdtok + SHELL_MAXTOK, tokbuf, sizeof(tokbuf));
+        for (j = 0; j < ntok; j++)
+        {
+            cmdtok[j] = (char *)(cmdtok + SHELL_MAXTOK) + (tok[j] - tokbuf);
+        }
+
         /* Spawn child thread for non-built-in commands */
         child =
-            create(commandtab[i].procedure,
-                   SHELL_CMDSTK, SHELL_CMDPRIO,
-                   commandtab[i].name, 2, ntok, tok);
+            clone(commandtab[i].procedure, SHELL_CMDPRIO,
+                  commandtab[i].name, 2, ntok, cmdtok);
+
+        /* The child has its own copy of the block from here on */
+        memfree(cmdtok, sizeof(tok) + sizeof(tokbuf));
 
         /* Ensure child command thread was created successfully */
         if (SYSERR == child)
@@ -0,0 +1,60 @@
+/**
+ * @file     xsh_irqstat.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <critical.h>
+
+/**
+ * @ingroup shell
+ *
+ * Shell command (irqstat) displays how long critical sections kept
+ * interrupts disabled, by function.
+ * @param nargs number of arguments in args array
+ * @param args  array of arguments
+ * @return non-zero value on error
+ */
+shellcmd xsh_irqstat(int nargs, char *args[])
+{
+    /* Output help, if '--help' argument was supplied */
+    if (nargs == 2 && strcmp(args[1], "--help") == 0)
+    {
+        printf("Usage: %s [-c]\n\n", args[0]);
+        printf("Description:\n");
+        printf("\tDisplays the time interrupts stayed disabled in each ");
+        printf("function\n");
+        printf("\tusing CS_DISABLE(), in cycles, longest section ");
+        printf("first.  Sections\n");
+        printf("\twhich switched threads are counted but not timed.  ");
+        printf("Functions are\n");
+        printf("\tprofiled only when built with IRQPROF set to TRUE in ");
+        printf("xinu.conf.\n");
+        printf("Options:\n");
+        printf("\t-c\t\tclear the table after displaying it\n");
+        printf("\t--help\t\tdisplay this help and exit\n");
+        return 0;
+    }
+
+    if (nargs > 2 || (nargs == 2 && strcmp(args[1], "-c") != 0))
+    {
+        fprintf(stderr, "%s: too many arguments\n", args[0]);
+        fprintf(stderr, "Try '%s --help' for more information\n",
+                args[0]);
+        return 1;
+    }
+
+#if !IRQPROF
+    printf("Not profiling: set IRQPROF to TRUE in xinu.conf and rebuild.\n");
+#endif
+    csdump();
+    if (nargs == 2)
+    {
+        csclear();
+    }
+
+    return 0;
+}
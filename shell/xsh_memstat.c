@@ -6,6 +6,10 @@
 
 #include <stddef.h>
 #include <platform.h>
+#include <framealloc.h>
+#include <clock.h>
+#include <interrupt.h>
+#include <paging.h>
 #include <mips.h>
 #include <memory.h>
 #include <safemem.h>
@@ -18,6 +22,8 @@
 #define PRINT_KERNEL  0x02
 #define PRINT_REGION  0x04
 #define PRINT_THREAD  0x08
+#define PRINT_SPACES  0x10
+#define PRINT_MACHINE 0x20
 
 extern char *maxaddr;
 extern void _start(void);
@@ -26,10 +32,11 @@ static void printMemUsage(void);
 static void printRegAllocList(void);
 static void printRegFreeList(void);
 static void printFreeList(struct memblock *, char *);
+static void printAddrSpaces(bool);
 
 static void usage(char *command)
 {
-    printf("Usage: %s [-r] [-k] [-q] [-t <TID>]\n\n", command);
+    printf("Usage: %s [-r] [-k] [-q] [-a] [-m] [-t <TID>]\n\n", command);
     printf("Description:\n");
     printf("\tDisplays the current memory usage and prints the\n");
     printf("\tfree list.\n");
@@ -38,6 +45,9 @@ static void usage(char *command)
     printf("\t-k\t\tprint kernel free list\n");
     printf("\t-q\t\tsuppress current system memory usage screen\n");
     printf("\t-t <TID>\tprint user free list of thread id tid\n");
+    printf("\t-a\t\tprint frame fragmentation and, for each thread,\n");
+    printf("\t\t\tits page tables, heap size and heap free list\n");
+    printf("\t-m\t\tprint the -a statistics alone as key=value lines\n");
     printf("\t--help\t\tdisplay this help and exit\n");
 }
 
@@ -93,6 +103,15 @@ shellcmd xsh_memstat(int nargs, char *args[])
         {
             print &= ~(PRINT_DEFAULT);
         }
+        else if (0 == strcmp(args[i], "-a"))
+        {
+            print |= PRINT_SPACES;
+        }
+        else if (0 == strcmp(args[i], "-m"))
+        {
+            print |= PRINT_SPACES | PRINT_MACHINE;
+            print &= ~(PRINT_DEFAULT);
+        }
     }
 
     if (print & PRINT_DEFAULT)
@@ -111,6 +130,11 @@ shellcmd xsh_memstat(int nargs, char *args[])
         printFreeList(&memlist, "kernel");
     }
 
+    if (print & PRINT_SPACES)
+    {
+        printAddrSpaces(print & PRINT_MACHINE);
+    }
+
     if (print & PRINT_THREAD)
     {
         if (isbadtid(tid))
@@ -119,6 +143,9 @@ shellcmd xsh_memstat(int nargs, char *args[])
         }
         else
         {
+            printf("Resident (%s): %u pages, %u bytes\n\n",
+                   thrtab[tid].name, thrtab[tid].rss,
+                   thrtab[tid].rss * FRAME_SIZE);
             printFreeList(&(thrtab[tid].memlist), thrtab[tid].name);
         }
     }
@@ -136,6 +163,7 @@ static void printMemUsage(void)
     uint kheap = 0;             /* total kernel heap memory       */
     uint kused = 0;             /* total used kernel heap memory  */
     uint kfree = 0;             /* total free memory              */
+    uint rss = 0;               /* total resident user pages      */
     struct memblock *block;     /* memory block pointer           */
 #ifdef UHEAP_SIZE
     uint uheap = 0;             /* total user heap memory         */
@@ -163,6 +191,7 @@ static void printMemUsage(void)
         if (thrtab[i].state != THRFREE)
         {
             stack += (ulong)thrtab[i].stklen;
+            rss += thrtab[i].rss;
         }
     }
 
@@ -209,7 +238,12 @@ static void printMemUsage(void)
     printf("%10d bytes user heap space (%d used)\n", uheap, uused);
 #endif                          /* UHEAP_SIZE */
     printf("----------------------------\n");
-    printf("%10d bytes physical memory\n\n", phys);
+    printf("%10d bytes physical memory\n", phys);
+    printf("%10d bytes resident in thread address spaces\n",
+           rss * FRAME_SIZE);
+    printf("%10d bytes in free frames\n", numfreeframes * FRAME_SIZE);
+    printf("%10d bytes in zeroed frame pool (%lu hits, %lu misses)\n\n",
+           zeropoolcount * FRAME_SIZE, zeropoolhits, zeropoolmisses);
 }
 
 /**
@@ -282,3 +316,135 @@ static void printFreeList(struct memblock *base, char *ident)
     }
     printf("\n");
 }
+
+/**
+ * Copy the memblock header at block in the address space of pagedir.
+ * @return TRUE if the header is mapped there
+ */
+static bool readBlock(uint *pagedir, struct memblock *block,
+                      struct memblock *copy)
+{
+    uint phys;
+    void *frame;
+
+    phys = pagelookup(pagedir, (uint)block);
+    if (SYSERR == phys)
+    {
+        return FALSE;
+    }
+    frame = kmap(truncframe(phys));
+    if (NULL == frame)
+    {
+        return FALSE;
+    }
+    /* memblocks are 8-byte aligned, so never straddle a page */
+    *copy = *(struct memblock *)((uint)frame + (phys & (FRAME_SIZE - 1)));
+    kunmap(frame);
+    return TRUE;
+}
+
+/**
+ * Print frame allocator fragmentation and, for each thread, what its page
+ * directory maps and the shape of its heap free list.  The free list lives
+ * in the thread's own address space, so it is followed through that page
+ * directory.
+ * @param machine print key=value lines for scripts rather than a table
+ */
+static void printAddrSpaces(bool machine)
+{
+    struct framestat fstat;
+    struct pagestat pstat;
+    struct memblock *block, copy;
+    struct thrent *thrptr;
+    uint nblocks, freebytes, largest;
+    irqmask im;
+    int i;
+
+    im = disable();
+    framestat(&fstat);
+    restore(im);
+
+    if (machine)
+    {
+        printf("memstat time=%lu\n", clktime);
+        printf("frames free=%u runs=%u largestrun=%u largespans=%u "
+               "pool=%u dmafree=%u\n", fstat.free, fstat.runs,
+               fstat.largestrun, fstat.largespans, zeropoolcount,
+               fstat.dmafree);
+    }
+    else
+    {
+        printf("Frames: %u free in %u runs, longest run %u, "
+               "%u free 4MB spans, %u zeroed in pool\n",
+               fstat.free, fstat.runs, fstat.largestrun, fstat.largespans,
+               zeropoolcount);
+        printf("        %u of %u DMA zone frames free\n\n", fstat.dmafree,
+               dmazoneframes);
+        printf("%3s %-16s %6s %6s %6s %6s %5s %6s %10s %6s %10s %10s\n",
+               "TID", "NAME", "RSS", "PAGES", "TABLES", "SHARED", "LARGE",
+               "FAULTS", "HEAP", "BLOCKS", "FREE", "LARGEST");
+        printf("%3s %-16s %6s %6s %6s %6s %5s %6s %10s %6s %10s %10s\n",
+               "---", "----------------", "------", "------", "------",
+               "------", "-----", "------", "----------", "------",
+               "----------", "----------");
+    }
+
+    for (i = 0; i < NTHREAD; i++)
+    {
+        thrptr = &thrtab[i];
+        nblocks = 0;
+        freebytes = 0;
+        largest = 0;
+
+        /* Hold the thread still while its tables and heap are read */
+        im = disable();
+        if (THRFREE == thrptr->state)
+        {
+            restore(im);
+            continue;
+        }
+        pagewalk(thrptr->pagedir, &pstat);
+        for (block = thrptr->memlist.next; NULL != block;
+             block = copy.next)
+        {
+            if (!readBlock(thrptr->pagedir, block, &copy))
+            {
+                break;
+            }
+            nblocks++;
+            freebytes += copy.length;
+            if (copy.length > largest)
+            {
+                largest = copy.length;
+            }
+            /* The list is sorted, so anything else means corruption */
+            if ((NULL != copy.next) && (copy.next <= block))
+            {
+                break;
+            }
+        }
+        restore(im);
+
+        if (machine)
+        {
+            printf("thread tid=%d rss=%u pages=%u tables=%u shared=%u "
+                   "large=%u faults=%u heap=%u freeblocks=%u freebytes=%u "
+                   "largestfree=%u name=%s\n", i, thrptr->rss,
+                   pstat.pages, pstat.tables, pstat.shared, pstat.large,
+                   thrptr->pgfaults, thrptr->brk - USERSPACE_BASE, nblocks,
+                   freebytes, largest, thrptr->name);
+        }
+        else
+        {
+            printf("%3d %-16s %6u %6u %6u %6u %5u %6u %10u %6u %10u %10u\n",
+                   i, thrptr->name, thrptr->rss, pstat.pages, pstat.tables,
+                   pstat.shared, pstat.large, thrptr->pgfaults,
+                   thrptr->brk - USERSPACE_BASE, nblocks, freebytes,
+                   largest);
+        }
+    }
+    if (!machine)
+    {
+        printf("\n");
+    }
+}
@@ -25,7 +25,7 @@ shellcmd xsh_ps(int nargs, char *args[])
     /* readable names for PR* status in thread.h */
     static const char * const pstnams[] = {
         "curr ", "free ", "ready", "recv ",
-        "sleep", "susp ", "wait ", "rtim "
+        "sleep", "susp ", "wait ", "rtim ", "migr ", "mbox "
     };
 
     /* Output help, if '--help' argument was supplied */
@@ -34,6 +34,9 @@ shellcmd xsh_ps(int nargs, char *args[])
         printf("Usage: %s\n\n", args[0]);
         printf("Description:\n");
         printf("\tDisplays a table of running threads.\n");
+        printf("\tRSS is the number of pages backed by frames in the ");
+        printf("thread's\n\taddress space, and STK the most pages its ");
+        printf("stack has used.\n");
         printf("Options:\n");
         printf("\t--help\t display this help and exit\n");
 
@@ -57,14 +60,14 @@ shellcmd xsh_ps(int nargs, char *args[])
             "--- ------------ ----- ---- ---- ---------- ---------- ----------\n");
 */
 
-    printf("%3s %-16s %5s %4s %4s %10s %-10s %10s\n",
+    printf("%3s %-16s %5s %4s %4s %10s %-10s %10s %5s %5s\n",
            "TID", "NAME", "STATE", "PRIO", "PPID", "STACK BASE",
-           "STACK PTR", "STACK LEN");
+           "STACK PTR", "STACK LEN", "RSS", "STK");
 
 
-    printf("%3s %-16s %5s %4s %4s %10s %-10s %10s\n",
+    printf("%3s %-16s %5s %4s %4s %10s %-10s %10s %5s %5s\n",
            "---", "----------------", "-----", "----", "----",
-           "----------", "----------", " ---------");
+           "----------", "----------", " ---------", "-----", "-----");
 
     /* Output information for each thread */
     for (i = 0; i < NTHREAD; i++)
@@ -75,13 +78,13 @@ shellcmd xsh_ps(int nargs, char *args[])
             continue;
         }
 
-        printf("%3d %-16s %s %4d %4d 0x%08lX 0x%08lX %10lu\n",
+        printf("%3d %-16s %s %4d %4d 0x%08lX 0x%08lX %10lu %5u %5u\n",
                i, thrptr->name,
                pstnams[(int)thrptr->state - 1],
                thrptr->prio, thrptr->parent,
                (ulong)thrptr->stkbase,
                (ulong)thrptr->stkptr,
-               thrptr->stklen);
+               thrptr->stklen, thrptr->rss, thrptr->stkpeak);
     }
 
     return 0;
@@ -0,0 +1,55 @@
+/**
+ * @file     xsh_trace.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <trace.h>
+
+/**
+ * @ingroup shell
+ *
+ * Shell command (trace) dumps the kernel trace ring buffer.
+ * @param nargs number of arguments in args array
+ * @param args  array of arguments
+ * @return non-zero value on error
+ */
+shellcmd xsh_trace(int nargs, char *args[])
+{
+    /* Output help, if '--help' argument was supplied */
+    if (nargs == 2 && strcmp(args[1], "--help") == 0)
+    {
+        printf("Usage: %s [-c]\n\n", args[0]);
+        printf("Description:\n");
+        printf("\tDisplays the kernel trace ring buffer, oldest ");
+        printf("record first.\n");
+        printf("\tEach record shows the time-stamp counter and the id ");
+        printf("of the thread\n");
+        printf("\twhich logged it.  Subsystems are traced only when ");
+        printf("built with a\n");
+        printf("\tTRACE_<SUBSYSTEM> level above TRACE_OFF.\n");
+        printf("Options:\n");
+        printf("\t-c\t\tclear the trace buffer after displaying it\n");
+        printf("\t--help\t\tdisplay this help and exit\n");
+        return 0;
+    }
+
+    if (nargs > 2 || (nargs == 2 && strcmp(args[1], "-c") != 0))
+    {
+        fprintf(stderr, "%s: too many arguments\n", args[0]);
+        fprintf(stderr, "Try '%s --help' for more information\n",
+                args[0]);
+        return 1;
+    }
+
+    tracedump();
+    if (nargs == 2)
+    {
+        traceclear();
+    }
+
+    return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file brk.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <framealloc.h>
+#include <memory.h>
+#include <paging.h>
+#include <thread.h>
+#include <trace.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Set the break of the current thread, the end of its heap.  The heap runs
+ * from ::USERSPACE_BASE up to the break; pages below it are backed on
+ * demand when touched, and a touch above it faults.  Lowering the break
+ * releases the frames behind the pages given up.
+ *
+ * memget() raises the break when nothing on the memlist fits and memtrim()
+ * lowers it over free memory at the top, so the memlist only ever covers
+ * memory below it.  Memory gained by moving the break directly is not on
+ * the memlist and must not be passed to memfree().
+ *
+ * @param addr
+ *      new break, rounded up to a page boundary
+ *
+ * @return
+ *      ::OK on success; ::SYSERR if @p addr is below ::USERSPACE_BASE or
+ *      the heap would reach the guard page below the stack.
+ */
+syscall brk(void *addr)
+{
+    struct thrent *thread;
+    irqmask im;
+    uint newbrk;
+
+    thread = &thrtab[thrcurrent];
+    newbrk = truncframe((uint)addr + FRAME_SIZE - 1);
+
+    if (((uint)addr < USERSPACE_BASE) || (newbrk < (uint)addr)
+        || (newbrk > USERSPACE_END - thread->stklen - STKGUARD))
+    {
+        return SYSERR;
+    }
+
+    im = disable();
+    if (newbrk < thread->brk)
+    {
+        thread->rss -= pagerelease(newbrk, thread->brk);
+    }
+    MEM_TRACE("brk 0x%08X to 0x%08X", thread->brk, newbrk);
+    thread->brk = newbrk;
+    restore(im);
+    return OK;
+}
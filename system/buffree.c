@@ -8,6 +8,7 @@
 #include <semaphore.h>
 #include <interrupt.h>
 #include <bufpool.h>
+#include <critical.h>
 
 /**
  * @ingroup memory_mgmt
@@ -42,10 +43,10 @@ syscall buffree(void *buffer)
 
     bfpptr = &bfptab[bufptr->poolid];
 
-    im = disable();
+    im = CS_DISABLE();
     bufptr->next = bfpptr->next;
     bfpptr->next = bufptr;
-    restore(im);
+    CS_RESTORE(im);
     signaln(bfpptr->freebuf, 1);
 
     return OK;
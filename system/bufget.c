@@ -8,6 +8,7 @@
 #include <semaphore.h>
 #include <interrupt.h>
 #include <bufpool.h>
+#include <critical.h>
 
 /**
  * @ingroup memory_mgmt
@@ -37,11 +38,11 @@ void *bufget(int poolid)
 
     bfpptr = &bfptab[poolid];
 
-    im = disable();
+    im = CS_DISABLE();
     wait(bfpptr->freebuf);
     bufptr = bfpptr->next;
     bfpptr->next = bufptr->next;
-    restore(im);
+    CS_RESTORE(im);
 
     bufptr->next = bufptr;
     return (void *)(bufptr + 1);        /* +1 to skip past accounting structure */
@@ -5,14 +5,16 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <thread.h>
+#include <monitor.h>
 
 /**
  * @ingroup threads
  *
- * Change the scheduling priority of a thread
+ * Change the scheduling priority of a thread.  A thread owning a monitor
+ * keeps any higher priority it inherited until it unlocks the monitor.
  * @param tid target thread
  * @param newprio new priority
- * @return old priority of thread
+ * @return old priority of thread, without inheritance
  */
 syscall chprio(tid_typ tid, int newprio)
 {
@@ -27,8 +29,9 @@ syscall chprio(tid_typ tid, int newprio)
         return SYSERR;
     }
     thrptr = &thrtab[tid];
-    oldprio = thrptr->prio;
-    thrptr->prio = newprio;
+    oldprio = thrptr->baseprio;
+    thrptr->baseprio = newprio;
+    moninherit(tid);
     restore(im);
     return oldprio;
 }
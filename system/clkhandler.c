@@ -7,23 +7,57 @@
 #include <queue.h>
 #include <clock.h>
 #include <thread.h>
+#include <timer.h>
 #include <platform.h>
 
 #if RTCLOCK
 
-void wakeup(void);
 int resched(void);
 
+#ifdef CLK_TICKLESS
+/** Ticks covered by the timer interrupt now pending */
+static ulong clkskip = 1;
+#endif
+
 /**
  * @ingroup timer
  *
  * Interrupt handler function for the timer interrupt.  This schedules a new
  * timer interrupt to occur at some point in the future, then updates ::clktime
- * and ::clkticks, then wakes sleeping threads if there are any, otherwise
- * reschedules the processor.
+ * and ::clkticks, then advances the timer wheel, which wakes sleeping threads,
+ * and reschedules the processor.
+ *
+ * When built with CLK_TICKLESS the next interrupt is not always one tick
+ * away.  If no other thread at the current priority level is ready there is
+ * nothing to time-slice, so the interrupt is deferred until the timer wheel
+ * next has work, at most ::CLK_MAXSKIP ticks ahead.
  */
 interrupt clkhandler(void)
 {
+#ifdef CLK_TICKLESS
+    ulong ticks;
+
+    for (ticks = clkskip; ticks > 0; ticks--)
+    {
+        clkticks++;
+        if (CLKTICKS_PER_SEC == clkticks)
+        {
+            clktime++;
+            clkticks = 0;
+        }
+        tmtick();
+    }
+
+    if (readyfirst() >= prio2level(thrtab[thrcurrent].prio))
+    {
+        clkskip = 1;
+    }
+    else
+    {
+        clkskip = tmnext(CLK_MAXSKIP);
+    }
+    clkupdate(clkskip * (platform.clkfreq / CLKTICKS_PER_SEC));
+#else
     clkupdate(platform.clkfreq / CLKTICKS_PER_SEC);
 
     /* Another clock tick passes. */
@@ -36,16 +70,11 @@ interrupt clkhandler(void)
         clkticks = 0;
     }
 
-    /* If sleepq is not empty, decrement first key.   */
-    /* If key reaches zero, call wakeup.              */
-    if (nonempty(sleepq) && (--firstkey(sleepq) <= 0))
-    {
-        wakeup();
-    }
-    else
-    {
-        resched();
-    }
+    /* Fire expired timers, readying threads whose sleep is over. */
+    tmtick();
+#endif
+
+    resched();
 }
 
 #endif /* RTCLOCK */
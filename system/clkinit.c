@@ -13,7 +13,7 @@
 #include <platform.h>
 #include <interrupt.h>
 #include <clock.h>
-#include <queue.h>
+#include <timer.h>
 
 /** @ingroup timer
  *
@@ -27,9 +27,6 @@ volatile ulong clkticks;
  * Number of seconds that have elapsed since the system booted.  */
 volatile ulong clktime;
 
-/** Queue of sleeping processes.  */
-qid_typ sleepq;
-
 /* TODO: Get rid of ugly x86 ifdef.  */
 #ifdef _XINU_PLATFORM_X86_
 extern void clockIRQ(void);
@@ -41,11 +38,11 @@ ulong time_intr_freq = 0;     /** frequency of XINU clock interrupt   */
 /**
  * @ingroup timer
  *
- * Initialize the clock and sleep queue.  This function is called at startup.
+ * Initialize the clock and timer wheel.  This function is called at startup.
  */
 void clkinit(void)
 {
-    sleepq = queinit();         /* initialize sleep queue       */
+    tminit();                   /* initialize timer wheel       */
 
     clkticks = 0;
 
@@ -57,11 +54,18 @@ void clkinit(void)
     /* TODO: Get rid of ugly x86 ifdef.  */
 #ifdef _XINU_PLATFORM_X86_
 	time_intr_freq = platform.clkfreq / CLKTICKS_PER_SEC;
+#ifdef CLK_TICKLESS
+	/* One-shot; clkupdate() rearms it from each interrupt */
+	outb(CLOCKCTL, 0x30);
+	outb(CLOCKBASE, time_intr_freq);
+	outb(CLOCKBASE, time_intr_freq >> 8);
+#else
 	outb(CLOCKCTL, 0x34);
 	/* LSB then MSB */
 	outb(CLOCKBASE, time_intr_freq);
 	outb(CLOCKBASE, time_intr_freq >> 8);
 	outb(CLOCKBASE, time_intr_freq >> 8); /* why??? */
+#endif
 	set_evec(IRQBASE, (ulong)clockIRQ);
 #else
     /* register clock interrupt */
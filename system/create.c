@@ -6,10 +6,18 @@
 #include <platform.h>
 #include <string.h>
 #include <thread.h>
+#include <monitor.h>
 #include <paging.h>
 #include <framealloc.h>
+#include <trace.h>
+#include <critical.h>
 
 static int thrnew(void);
+static tid_typ thrspawn(void *procaddr, uint ssize, int priority,
+                        const char *name, bool share, int nargs, va_list ap);
+static int sharepages(uint *newpagedir, uint stacklimit, uint *ptmap);
+static void spawnundo(uint *newpagedir, uint pagediraddr, uint *ptmap);
+static void *kmapuser(uint *newpagedir, uint addr);
 
 /**
  * @ingroup threads
@@ -19,7 +27,9 @@ static int thrnew(void);
  * @param procaddr
  *      procedure address
  * @param ssize
- *      stack size in bytes
+ *      largest size the stack may grow to in bytes, rounded up to whole
+ *      pages.  Stack pages are backed by frames only once they are touched,
+ *      and an unmapped guard page below the stack catches overflow.
  * @param priority
  *      thread priority (0 is lowest priority)
  * @param name
@@ -35,97 +45,173 @@ static int thrnew(void);
 tid_typ create(void *procaddr, uint ssize, int priority,
                const char *name, int nargs, ...)
 {
-  kprintf("Attempting to create--------------------------------\n");
+    tid_typ tid;
+    va_list ap;
+
+    va_start(ap, nargs);
+    tid = thrspawn(procaddr, ssize, priority, name, FALSE, nargs, ap);
+    va_end(ap);
+
+    return tid;
+}
+
+/**
+ * @ingroup threads
+ *
+ * Create a thread which starts out with a copy of the calling thread's
+ * address space.  Heap pages are shared copy-on-write rather than copied,
+ * so pointers into the caller's heap remain valid in the new thread and
+ * only the pages either thread later writes are duplicated.  The new
+ * thread gets a fresh stack of the caller's stack size and inherits the
+ * caller's free memory list.
+ *
+ * @param procaddr
+ *      procedure address
+ * @param priority
+ *      thread priority (0 is lowest priority)
+ * @param name
+ *      name of the thread, used for debugging
+ * @param nargs
+ *      number of arguments that follow
+ * @param ...
+ *      arguments to pass to thread procedure
+ * @return
+ *      the new thread's thread id, or ::SYSERR if a new thread could not be
+ *      created (not enough memory or thread entries).
+ */
+tid_typ clone(void *procaddr, int priority, const char *name, int nargs, ...)
+{
+    tid_typ tid;
+    va_list ap;
+
+    va_start(ap, nargs);
+    tid = thrspawn(procaddr, thrtab[thrcurrent].stklen, priority, name,
+                   TRUE, nargs, ap);
+    va_end(ap);
+
+    return tid;
+}
+
+/*
+ * Build a new thread with its own page directory.  If `share` is set, the
+ * calling thread's user pages outside its stack are shared with the new
+ * thread copy-on-write; otherwise the new thread gets an empty heap.
+ */
+static tid_typ thrspawn(void *procaddr, uint ssize, int priority,
+                        const char *name, bool share, int nargs, va_list ap)
+{
     irqmask im;                 /* saved interrupt state               */
     ulong *saddr;               /* stack address                       */
+    void *stkptr;               /* initial stack pointer               */
     tid_typ tid;                /* new thread ID                       */
     struct thrent *thrptr;      /* pointer to new thread control block */
-    va_list ap;                 /* list of thread arguments            */
 
-    im = disable();
+    im = CS_DISABLE();
 
     // Initialize the new thread's paging structures
-    uint pagediraddr = framealloc();
-
-    // To initialize the data structures of the new thread, we will take the first four page table entries
-    // in the second page table of the currently running thread (with virtual address 0x00400000) and readdress them to point to the
-    // frames which will be used in the new thread.
-    // In particular, we will have a page entry for modifying page directory entries, a page table's entries
-    // (and we can update which page table), and the entries in two pages
-    // This allows us to initialize the new thread's page directory, stack, and memlist
-
-    // Obviously, there are more compact ways to do this but I think this is the clearest to understand
-
-    ////////////////////////////////
-    // Use re-addressing to initialize the new thread's page directory
-
-    // First, we must initialize the page table in the current thread if it hasn't been allocated
-    uint *pagedirentry = (uint*)0xFFFFF004; //pagedirentry of the currently running thread
-    bool hadtomakepagetable = FALSE;
-    if(get_bit(*pagedirentry, 0) == 0) {
-      hadtomakepagetable = TRUE;
-      *pagedirentry = framealloc() | 3;
+    // The new thread's directory, page tables and pages are all filled in through temporary kernel
+    // mappings from kmap(), which leaves the current thread's own mappings untouched
+    uint pagediraddr = framealloc_zeroed();
+    if (SYSERR == pagediraddr)
+    {
+        CS_RESTORE(im);
+        return SYSERR;
     }
-
-    // Now we can use the page table
-    uint *currpagetablemodifier = (uint*)0xFFC01000;
-    // Save the current pte values so we can restore them later
-    uint savedptes[4];
-    int i;
-    for(i = 0; i < 4; i++) {
-      savedptes[i] = *(currpagetablemodifier + i);
+    uint *newpagedir = kmap(pagediraddr);
+    if (NULL == newpagedir)
+    {
+        freeframe(pagediraddr);
+        CS_RESTORE(im);
+        return SYSERR;
     }
-
-    // Describe the 4 values to be used to create the new thread
-    //uint *newfirstpage = (uint*)0x00400000;
-    uint *newfirstpagemodifier = currpagetablemodifier + 0;
-    //uint *newsecondpage = (uint*)0x00401000;
-    uint *newsecondpagemodifier = currpagetablemodifier + 1;
-    uint *newpagedir = (uint*)0x00402000;
-    uint *newpagedirmodifier = currpagetablemodifier + 2;
-    uint *newpagetable = (uint*)0x00403000;
-    uint *newpagetablemodifier = currpagetablemodifier + 3;
-    
-    // Point the pte to our new page directory
-    *newpagedirmodifier = pagediraddr | 3;
-    // Now we can use the variable newpagedir as a virtual pointer to the pagedirectory's contents
-    initpagetable(newpagedir);
-    // Map the kernel identity table
-    *newpagedir = (uint)kernelidentitytable | 3;
+    // Map the kernel space and the kmap() slots, which every directory shares
+    *newpagedir = kernelpde;
+    *(newpagedir + (KMAP_BASE >> 22)) = (uint)kmaptable | 3;
     // Map the page directory to itself
     *(newpagedir + 1023) = pagediraddr | 3;
+    // Page tables present in the new directory, copied to the thread entry once there is one
+    uint ptmap[PTMAP_WORDS];
+    memset(ptmap, 0, sizeof(ptmap));
 
-    //////////////////////////////
-    // Now we use this same re-addressing technique to initialize the new thread's stack
-    
     if (ssize < MINSTK)
     {
         ssize = MINSTK;
     }
+    // The stack region and the guard page below it are whole pages
+    ssize = truncframe(ssize + FRAME_SIZE - 1);
+
+    // Pages backed for the new thread, shared ones included
+    uint resident = 0;
+
+    // A clone starts out sharing everything below its stack with the current thread
+    if(share) {
+      int shared = sharepages(newpagedir, USERSPACE_END - ssize - STKGUARD, ptmap);
+      if(SYSERR == shared) {
+        spawnundo(newpagedir, pagediraddr, ptmap);
+        CS_RESTORE(im);
+        return SYSERR;
+      }
+      resident += shared;
+    }
 
     /* Allocate new stack.  */
-    //saddr = stkget(ssize);
-    saddr = (ulong*) (USERSPACE_END - ssize);
-    // Give it an extra page of stack size since setting up the stack requires accessing several addresses
-    // south of saddr
-    pageregionwith(USERSPACE_END - ssize - 0x1000, USERSPACE_END - 1, newpagedir, newpagetablemodifier, newpagetable);
-	
-    if (SYSERR == (int)saddr)
-    {
-      // TODO: Resolve re-addressing for paging
-        restore(im);
+    // The stack occupies the top ssize bytes of user space and saddr is its topmost word.
+    // The heap may grow up to STKGUARD bytes short of it, leaving a guard page which is never backed
+    saddr = (ulong*) (USERSPACE_END - sizeof(ulong));
+    // Only back the page holding saddr, which the context record and arguments fit in.
+    // The rest of the stack is paged in on demand
+    if(pageregionwith((uint)saddr, (uint)saddr, newpagedir, ptmap) == 0) {
+      spawnundo(newpagedir, pagediraddr, ptmap);
+      CS_RESTORE(im);
+      return SYSERR;
+    }
+    resident++;
+
+    // A new heap's first memblock lives at the start of the new thread's user space, so back that
+    // page and write the memblock through a temporary mapping of it
+    struct memblock *memlistnext = (struct memblock*)(USERSPACE_BASE + sizeof(struct memblock));
+    if(!share) {
+      uint *newfirstpage = NULL;
+      if(pageregionwith(USERSPACE_BASE, USERSPACE_BASE + 0x1000, newpagedir, ptmap) != 0) {
+        newfirstpage = kmapuser(newpagedir, USERSPACE_BASE);
+      }
+      if(newfirstpage == NULL) {
+        spawnundo(newpagedir, pagediraddr, ptmap);
+        CS_RESTORE(im);
         return SYSERR;
+      }
+      resident++;
+
+      struct memblock *memlistnextwindow = (struct memblock*)((uint)newfirstpage + sizeof(struct memblock));
+      memlistnextwindow->next = NULL;
+      // The heap starts out HEAP_CHUNK long and memget() raises its break as it fills up
+      memlistnextwindow->length = HEAP_CHUNK - sizeof(struct memblock);
+      kunmap(newfirstpage);
     }
 
+    /* Set up new thread's stack with context record and arguments.
+     * Architecture-specific.  */
+    // Map the frame holding saddr; svirtualaddr is saddr's offset within that mapping, and when the
+    // thread is running its stack pointer will see the values written there
+    uint *newstackpage = kmapuser(newpagedir, (uint)saddr);
+    if(newstackpage == NULL) {
+      spawnundo(newpagedir, pagediraddr, ptmap);
+      CS_RESTORE(im);
+      return SYSERR;
+    }
+    uint *svirtualaddr = (uint*)((uint)newstackpage + ((uint)saddr & 0x00000FFF));
+    stkptr = setupVirtualStack(saddr, svirtualaddr, procaddr, INITRET, nargs, ap);
+    kunmap(newstackpage);
+
     /* Allocate new thread ID.  */
     tid = thrnew();
     if (SYSERR == (int)tid)
     {
-      // TODO: Resolve re-addressing for paging
-        stkfree(saddr, ssize);
-        restore(im);
+        spawnundo(newpagedir, pagediraddr, ptmap);
+        CS_RESTORE(im);
         return SYSERR;
     }
+    kunmap(newpagedir);
 
     /* Set up thread table entry for new thread.  */
     thrcount++;
@@ -133,93 +219,186 @@ tid_typ create(void *procaddr, uint ssize, int priority,
 
     thrptr->state = THRSUSP;
     thrptr->prio = priority;
+    thrptr->baseprio = priority;
+    thrptr->monwait = NOMON;
     thrptr->stkbase = saddr;
     thrptr->stklen = ssize;
+    thrptr->stkptr = stkptr;
+    thrptr->csdepth = 0;
     strlcpy(thrptr->name, name, TNMLEN);
     thrptr->parent = gettid();
     thrptr->hasmsg = FALSE;
+    thrptr->msgqmax = 0;
+    thrptr->msgdrops = 0;
 
     thrptr->pagedir = (uint*)pagediraddr;
+    thrptr->pgfaults = 0;
+    thrptr->untrimmed = 0;
 
-    // Setup memlist stuff
-    // Page the region using re-addressing
-    pageregionwith(USERSPACE_BASE, USERSPACE_BASE + 0x1000, newpagedir, newpagetablemodifier, newpagetable);
-    // Now, for the purposes of re-addressing, we are going to point newfirstpage so that it points to the page which will be used
-    // in the new thread
-    // In particular, we are going to read off the page table address from the page directory, and use it to point newpagetable
-    // to that page
-    // Then we shall read that to get the address of the frame corresponding to virtual addresses 0x00400000-0x00401000 for the new
-    // thread, and point newfirstpage's modifier so that it points to that frame
-    // Since newfirstpage corresponds to virtual addresses 0x00400000, we can hence use those addresses to modify the intended frame
-    // for the new thread
-    *newpagetablemodifier = *(newpagedir + 1) | 3;
-    kprintf("*newpagetablemodifier: 0x%8.8X\n", *newpagetablemodifier);
-    *newfirstpagemodifier = *newpagetable | 3;
-    kprintf("*newfirstpagemodifier: 0x%8.8X\n", *newfirstpagemodifier);
-    
-    // First, create the memblock for the thread->memlist
-    // This is a bad hack, but gcc's giving me weird type issues otherwise
-    uint *memlisteditor = (uint*) &(thrptr->memlist);
-    *memlisteditor = USERSPACE_BASE;
-    // Now, create the memblock for the first memblock
-    struct memblock *memlistnext = (struct memblock*)(USERSPACE_BASE + sizeof(struct memblock));
-    // Initialize those data structures
-    memlistnext->next = NULL;
-    memlistnext->length = USERSPACE_END - USERSPACE_BASE - ssize - sizeof(struct memblock);
-    thrptr->memlist.next = memlistnext;
-    thrptr->memlist.length = USERSPACE_END - USERSPACE_BASE - ssize - sizeof(struct memblock);
-    kprintf("done setting up memlist stuff\n");
+    if(share) {
+      // The heap, memlist and slab free lists included, is a copy of the current thread's
+      thrptr->memlist = thrtab[thrcurrent].memlist;
+      thrptr->brk = thrtab[thrcurrent].brk;
+      memcpy(thrptr->slabfree, thrtab[thrcurrent].slabfree, sizeof(thrptr->slabfree));
+      // and so are its attached segments, which sharepages() left mapped
+      memcpy(thrptr->shmmaps, thrtab[thrcurrent].shmmaps, sizeof(thrptr->shmmaps));
+    } else {
+      // Setup memlist stuff
+      // First, create the memblock for the thread->memlist
+      // This is a bad hack, but gcc's giving me weird type issues otherwise
+      uint *memlisteditor = (uint*) &(thrptr->memlist);
+      *memlisteditor = USERSPACE_BASE;
+      thrptr->memlist.next = memlistnext;
+      thrptr->memlist.length = HEAP_CHUNK - sizeof(struct memblock);
+      thrptr->brk = USERSPACE_BASE + HEAP_CHUNK;
+      memset(thrptr->slabfree, 0, sizeof(thrptr->slabfree));
+      memset(thrptr->shmmaps, 0, sizeof(thrptr->shmmaps));
+    }
+    thrptr->rss = resident;
+    thrptr->stkpeak = 1;
+    memcpy(thrptr->ptmap, ptmap, sizeof(ptmap));
 
     /* Set up default file descriptors.  */
     thrptr->fdesc[0] = CONSOLE; /* stdin  is console */
     thrptr->fdesc[1] = CONSOLE; /* stdout is console */
     thrptr->fdesc[2] = CONSOLE; /* stderr is console */
 
-    /* Set up new thread's stack with context record and arguments.
-     * Architecture-specific.  */
-    va_start(ap, nargs);
-    
-    // Now I need to do the same thing, where I'm going to use logicalfirstaddr and logicalsecondaddr to point to the pages
-    // To do this, I need to set up a virtual region where we can modify the frames which will make up the stack
-    // Since setupStack actually goes a little below saddr, we need to include the page below it.
-    // Hence, we will map page 0x00401000 to the page containing saddr and page 0x00400000 to the page below that
-    *newpagetablemodifier = *(newpagedir + (((uint)saddr & 0xFFC00000) >> 22)); // Get the page directory index from saddr
-    // Technically, the stack and the lower addresses accessed could potentially be in different page tables
-    // This would imply a stack larger than 0x00400000 though, so it's kinda unrealistic to assume that
-    uint firststackframeaddr =   *(newpagetable + ((((uint)saddr & 0x003FF000) >> 12) - 1));
-    *newfirstpagemodifier = firststackframeaddr | 3;
-    uint secondstackframeaddr =  *(newpagetable + (((uint)saddr & 0x003FF000) >> 12));
-    *newsecondpagemodifier = secondstackframeaddr | 3;
-
-    // Take the offset of saddr in its page and put it in the 0x00401000 page
-    // Now svirtualaddr can be modified and later on when the thread is running, the thread's virtual stack pointer will see those changes
-    uint *svirtualaddr = (uint*)(0x00401000 + ((uint)saddr & 0x0000000F));
-    thrptr->stkptr = setupVirtualStack(saddr, svirtualaddr, procaddr, INITRET, nargs, ap);
-    va_end(ap);
+    THREAD_TRACE("Created thread %d, %s, page directory 0x%08X", tid, thrptr->name, pagediraddr);
 
-    // Reload CR3 with the address of the currently running thread
-    //loadCR3(thrtab[thrcurrent].pagedir);
+    /* Restore interrupts and return new thread TID.  */
+    CS_RESTORE(im);
 
-    // Restore the original value of the currently running thread's pte
-    for(i = 0; i < 4; i++) {
-      *(currpagetablemodifier + i) = savedptes[i];
-    }
-    if(hadtomakepagetable) {
-      freeframe((*pagedirentry) & 0xFFFFFFF0); // Clear the rightmost flag bits
-      *pagedirentry = 0x00000000;
+    return tid;
+}
+
+/*
+ * Undo a thrspawn() which failed part way: release the temporary mapping of the new
+ * directory at `newpagedir` and every frame built for it, tables marked in `ptmap`
+ * and references taken on shared frames included.
+ */
+static void spawnundo(uint *newpagedir, uint pagediraddr, uint *ptmap)
+{
+    kunmap(newpagedir);
+    reclaimframes((uint*)pagediraddr, ptmap);
+}
+
+/*
+ * Temporarily map the frame backing user address `addr` in the directory mapped at
+ * `newpagedir`, whose page is already present.  Returns the mapping, to be released with
+ * kunmap(), or NULL if no kmap() slot was free.
+ */
+static void *kmapuser(uint *newpagedir, uint addr)
+{
+    uint *newpagetable;
+    uint pte;
+
+    newpagetable = kmap(*(newpagedir + (addr >> 22)) & ~(FRAME_SIZE - 1));
+    if (NULL == newpagetable)
+    {
+        return NULL;
     }
+    pte = *(newpagetable + ((addr & 0x003FF000) >> 12));
+    kunmap(newpagetable);
 
-    /* Restore interrupts and return new thread TID.  */
-    restore(im);
-    kprintf("Done creating\n");
+    return kmap(pte);
+}
+
+/*
+ * Share every present user page of the current thread below `stacklimit` with the page
+ * directory mapped at `newpagedir`.  Page tables are copied rather than shared, since
+ * each thread edits its own tables through the recursive mapping; the data frames they
+ * point at are shared, with both mappings made read-only and marked PAGE_COW so the first
+ * write from either thread takes a private copy.  A frame whose reference count is
+ * saturated is copied for the new thread straight away instead.  Pages of shared memory
+ * segments are left writable, so both threads go on seeing the segment.  The copied
+ * tables are marked in `ptmap`.
+ * Returns the number of pages mapped, copies included, or SYSERR if a frame, a reference or a kmap() slot
+ * ran out; what was built by then is left in `newpagedir` for the caller to reclaim.
+ */
+static int sharepages(uint *newpagedir, uint stacklimit, uint *ptmap)
+{
+    uint *pagedir = (uint*)0xFFFFF000;
+    uint *pagetable, *newpagetable;
+    uint *pte;
+    uint pagetableaddr, pageaddr, frameaddr;
+    void *copy;
+    uint i, j;
+    int shared = 0;
+
+    // Entries below user space are shared by every directory and entry 1023 maps the directory itself
+    for(i = USERSPACE_BASE >> 22; i < 1023 && (i << 22) < stacklimit; i++) {
+      if(get_bit(*(pagedir + i), 0) == 0) {
+        continue;
+      }
+      // Frames are shared page by page, so a large page is split up first
+      if(pagesplit(i << 22) == SYSERR) {
+        return SYSERR;
+      }
+
+      pagetableaddr = framealloc_zeroed();
+      if(pagetableaddr == SYSERR) {
+        return SYSERR;
+      }
+      newpagetable = kmap(pagetableaddr);
+      if(newpagetable == NULL) {
+        freeframe(pagetableaddr);
+        return SYSERR;
+      }
+      // The table goes into the directory before it is filled, so a failure part way through
+      // still leaves every reference taken where reclaimframes() will find it
+      *(newpagedir + i) = pagetableaddr | 3;
+      ptmapset(ptmap, i);
+      pagetable = (uint*)(0xFFC00000 + 0x1000 * i);
 
-    // So we don't loop, to make output easier to read
-    /*
-    while(1){
+      for(j = 0; j < 1024; j++) {
+        pageaddr = (i << 22) | (j << 12);
+        if(pageaddr >= stacklimit) {
+          break;
+        }
+
+        pte = pagetable + j;
+        if(get_bit(*pte, 0) == 0) {
+          continue;
+        }
+
+        if(frameref(*pte & ~(FRAME_SIZE - 1)) == OK) {
+          // Shared memory segments stay writable in both, so they remain shared
+          if(!(*pte & PAGE_SHARED)) {
+            *pte = (*pte & ~PAGE_RW) | PAGE_COW;
+            invlpg(pageaddr);
+          }
+          *(newpagetable + j) = *pte;
+          shared++;
+          continue;
+        }
+
+        // A segment page can't be copied without splitting the segment
+        if(*pte & PAGE_SHARED) {
+          kunmap(newpagetable);
+          return SYSERR;
+        }
+        // No reference is left to count another mapping, so the new thread gets its own copy
+        frameaddr = framealloc();
+        if(frameaddr == SYSERR) {
+          kunmap(newpagetable);
+          return SYSERR;
+        }
+        copy = kmap(frameaddr);
+        if(copy == NULL) {
+          freeframe(frameaddr);
+          kunmap(newpagetable);
+          return SYSERR;
+        }
+        memcpy(copy, (void*)pageaddr, FRAME_SIZE);
+        kunmap(copy);
+        *(newpagetable + j) = frameaddr | PAGE_RW | PAGE_PRESENT;
+        shared++;
+      }
+
+      kunmap(newpagetable);
     }
-    */
-    
-    return tid;
+
+    return shared;
 }
 
 /*
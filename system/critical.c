@@ -0,0 +1,149 @@
+/**
+ * @file critical.c
+ * Critical section profiling.
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <critical.h>
+#include <tsc.h>
+
+struct csent cstab[NCSENT];
+ulong csswitches;               /* context switches, counted by resched() */
+uint csdepth;                   /* sections the current thread is inside  */
+
+static ulong csstart;           /* time-stamp when interrupts were masked */
+static ulong csepoch;           /* csswitches when interrupts were masked */
+
+/**
+ * Disable interrupts, starting the clock for the outermost section.  Use
+ * through CS_DISABLE(), which names the calling function.
+ * @param name  function entering the critical section
+ * @return the interrupt mask to pass to csrestore()
+ */
+irqmask csdisable(const char *name)
+{
+    irqmask im;
+
+    im = disable();
+    if (0 == csdepth++)
+    {
+        csepoch = csswitches;
+        csstart = rdtsc();
+    }
+    return im;
+}
+
+/**
+ * Restore interrupts, charging the section to the function if it was the
+ * outermost one.  The first section of a function claims a free entry by
+ * hashing the name's address; once the table is full, new functions are
+ * not recorded.
+ * @param im    mask returned by csdisable()
+ * @param name  function leaving the critical section
+ */
+void csrestore(irqmask im, const char *name)
+{
+    struct csent *entry;
+    ulong cycles;
+    uint i, slot;
+
+    if (0 == --csdepth)
+    {
+        cycles = rdtsc() - csstart;
+        slot = ((uint)name >> 2) & (NCSENT - 1);
+        for (i = 0; i < NCSENT; i++)
+        {
+            entry = &cstab[(slot + i) & (NCSENT - 1)];
+            if (NULL == entry->name)
+            {
+                entry->name = name;
+            }
+            if (name == entry->name)
+            {
+                if (csepoch != csswitches)
+                {
+                    entry->switched++;
+                    break;
+                }
+                entry->count++;
+                entry->total += cycles;
+                if (cycles > entry->max)
+                {
+                    entry->max = cycles;
+                }
+                break;
+            }
+        }
+    }
+    restore(im);
+}
+
+/**
+ * Print the critical section table, longest section first.  Times are in
+ * time-stamp counter cycles.
+ */
+void csdump(void)
+{
+    struct csent *sorted[NCSENT], *entry;
+    ulong avg;
+    uint i, j, n;
+
+    /* Insertion sort of the used entries by longest section */
+    n = 0;
+    for (i = 0; i < NCSENT; i++)
+    {
+        entry = &cstab[i];
+        if (NULL == entry->name)
+        {
+            continue;
+        }
+        for (j = n++; (j > 0) && (sorted[j - 1]->max < entry->max); j--)
+        {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = entry;
+    }
+
+    printf("%-20s %8s %10s %10s %12s %8s\n", "FUNCTION", "COUNT",
+           "MAX", "AVG", "TOTAL/1024", "SWITCHED");
+    printf("%-20s %8s %10s %10s %12s %8s\n", "--------------------",
+           "--------", "----------", "----------", "------------",
+           "--------");
+    for (i = 0; i < n; i++)
+    {
+        entry = sorted[i];
+        /* No 64-bit division in the kernel, so average in 1024s if big */
+        avg = 0;
+        if (entry->count > 0)
+        {
+            avg = (entry->total >> 32)
+                ? ((ulong)(entry->total >> 10) / entry->count) << 10
+                : (ulong)entry->total / entry->count;
+        }
+        printf("%-20s %8lu %10lu %10lu %12lu %8lu\n", entry->name,
+               entry->count, entry->max, avg,
+               (ulong)(entry->total >> 10), entry->switched);
+    }
+}
+
+/**
+ * Discard everything recorded in the critical section table.
+ */
+void csclear(void)
+{
+    irqmask im;
+    uint i;
+
+    im = disable();
+    for (i = 0; i < NCSENT; i++)
+    {
+        cstab[i].name = NULL;
+        cstab[i].count = 0;
+        cstab[i].max = 0;
+        cstab[i].total = 0;
+        cstab[i].switched = 0;
+    }
+    restore(im);
+}
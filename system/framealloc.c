@@ -1,15 +1,85 @@
 /**
  * @file framealloc.c
  * Definitions and initialization for page frame allocation
+ *
+ * Frames are tracked with a two-level bitmap.  Each word of framelist describes
+ * 32 frames (a set bit means the frame is in use), and each word of framesummary
+ * describes 32 words of framelist (a set bit means that framelist word is full).
+ * Finding a free frame is then a find-first-zero in a summary word followed by a
+ * find-first-zero in the framelist word it points at.
+ *
+ * Frames mapped into more than one page directory (copy-on-write clones) carry a share
+ * count in framerefs holding the number of references beyond the first.
+ *
+ * A small pool of frames which are already zeroed is kept topped up by the null thread,
+ * so framealloc_zeroed() is usually just a pop.  Once a large page has been asked for, the null
+ * thread also keeps one large page zeroed, a frame per idle pass, so pageinlarge() never has to
+ * clear 4MB with interrupts off.  Both count as free and are given up when memory runs out.
+ *
+ * The frames below dmazoneend make up the DMA zone, which ends at DMA_ZONE_END but never
+ * takes more than half of memory, so there is always a normal zone above it.  Every allocator
+ * searches the normal zone first, so the low frames stay free for framealloc_contig() to hand
+ * out as physically contiguous, aligned buffers for devices.  Each zone is a whole number of
+ * summary words.
  */
 
 #include <framealloc.h>
+#include <interrupt.h>
+#include <memory.h>
 #include <platform.h>
 #include <stdio.h>
+#include <stdlib.h>
+
+#if DMA_ZONE_END % LARGE_PAGE_SIZE != 0
+#error "DMA_ZONE_END must be a multiple of LARGE_PAGE_SIZE"
+#endif
 
 // Definitions of declared global vars
 uint framebaseaddr;
 uint numframetableentries;
+uint *framesummary;
+uint numsummaryentries;
+uint lastallocatedframe;
+uint numfreeframes;
+uint dmazoneframes;
+uint dmazoneend;
+uchar *framerefs;
+uint zeropoolcount;
+ulong zeropoolhits;
+ulong zeropoolmisses;
+
+// Zeroed frames, used as a stack
+static uint zeropool[ZPOOL_HIGH];
+// Set while the pool is being refilled from below ZPOOL_LOW
+static bool zeropoolfilling;
+// The large page being zeroed for pageinlarge(), or SYSERR if none is held, and how many of
+// its frames are zeroed so far
+static uint zerolarge = SYSERR;
+static uint zerolargedone;
+// Set once a large page has been asked for, so one is only kept ready for threads using them
+static bool zerolargewanted;
+
+/**
+ * Returns the index of the lowest set bit in `word`, which must be nonzero
+ */
+static inline uint bitscanforward(uint word) {
+  uint index;
+  __asm__("bsf %1, %0" : "=r" (index) : "rm" (word));
+  return index;
+}
+
+/**
+ * Marks frame number `frame` as occupied, updating the summary if its bitmap word fills up
+ */
+static inline void markframe(uint frame) {
+  uint entry = frame / 32;
+
+  *(framelist + entry) |= (0x00000001 << (frame % 32));
+  if(*(framelist + entry) == 0xFFFFFFFF) {
+    *(framesummary + entry / 32) |= (0x00000001 << (entry % 32));
+  }
+  numfreeframes--;
+}
 
 /**
  * Initialize the necessary structures for page frame allocation
@@ -17,52 +87,599 @@ uint numframetableentries;
  */
 syscall initframealloc() {
   // framelist is apointer to the first entry of the bitmap frame table
-  numframetableentries = ((USERSPACE_END - USERSPACE_BASE) / FRAME_SIZE) / 32;
+  // Frames cover the memory above the kernel space, up to the end of RAM the platform reports.
+  // The bitmap is a whole number of summary words, so each one describes a 4MB-aligned span which
+  // may be handed out as a large page, and frames past the end of RAM in the last span are marked
+  // in use for good
+  uint ramend = (uint)platform.maxaddr;
+  if(ramend > USERSPACE_END) {
+    ramend = USERSPACE_END;
+  }
+  uint ramframes = (ramend > KERNELSPACE_END) ? (ramend - KERNELSPACE_END) / FRAME_SIZE : 0;
+  numframetableentries = ((ramframes + 1023) / 1024) * 32;
   // Note that we divide by 32 since a single word describes the state of 32 pages
 
+  // The summary words sit directly after the bitmap, one bit per bitmap word
+  framesummary = framelist + numframetableentries;
+  numsummaryentries = (numframetableentries + 31) / 32;
+
+  // Share counts follow, one byte per frame
+  framerefs = (uchar*)(framesummary + numsummaryentries);
+
+  // The kernel heap begins after the frame table and its share counts
+  memheap = (void *)(framerefs + numframetableentries * 32);
+
   // Set the base address of the first frame to allocate
-  framebaseaddr = USERSPACE_BASE;
+  framebaseaddr = KERNELSPACE_END;
+  numfreeframes = numframetableentries * 32;
+  // The DMA zone stops at DMA_ZONE_END or half of memory, whichever is lower, so a machine with
+  // little memory still has a normal zone
+  dmazoneend = ramend / 2;
+  if(dmazoneend > DMA_ZONE_END) {
+    dmazoneend = DMA_ZONE_END;
+  }
+  dmazoneend &= ~(LARGE_PAGE_SIZE - 1);
+  if(dmazoneend < framebaseaddr) {
+    dmazoneend = framebaseaddr;
+  }
+  dmazoneframes = (dmazoneend - framebaseaddr) / FRAME_SIZE;
+  // Allocation starts just above the DMA zone, if any memory lies there
+  lastallocatedframe = (dmazoneframes < ramframes) ? dmazoneframes : 0;
 
   // Zero out all frame table entries to mark the frames as clear
   uint i;
   for(i = 0; i < numframetableentries; i++) {
     *((uint*)framelist + i) = 0x00000000;
   }
+  for(i = 0; i < numsummaryentries; i++) {
+    *(framesummary + i) = 0x00000000;
+  }
+  for(i = 0; i < numframetableentries * 32; i++) {
+    *(framerefs + i) = 0;
+  }
+
+  // Summary bits past the end of the bitmap describe nothing, so mark them full
+  for(i = numframetableentries; i < numsummaryentries * 32; i++) {
+    *(framesummary + i / 32) |= (0x00000001 << (i % 32));
+  }
+  // Frames which don't exist are never free
+  for(i = ramframes; i < numframetableentries * 32; i++) {
+    markframe(i);
+  }
 
   return OK;
 }
 
+/**
+ * Find and take a free frame in the summary words [first, last), beginning the search at summary
+ * word `start` and wrapping around within the range
+ * @return The physical address of the frame, or SYSERR if the range has no free frame
+ */
+static uint allocrange(uint first, uint last, uint start) {
+  uint summaryindex = (start >= first && start < last) ? start : first;
+  uint i;
+
+  for(i = first; i < last; i++) {
+    uint summary = *(framesummary + summaryindex);
+
+    if(summary != 0xFFFFFFFF) {
+      // Find the first bitmap word that isn't full, then the first free frame within it
+      uint entry = summaryindex * 32 + bitscanforward(~summary);
+      uint frame = entry * 32 + bitscanforward(~*(framelist + entry));
+
+      markframe(frame);
+      lastallocatedframe = frame;
+
+      return (uint) (framebaseaddr + frame * FRAME_SIZE);
+    }
+
+    if(++summaryindex == last) {
+      summaryindex = first;
+    }
+  }
+  return SYSERR;
+}
+
 /**
  * Allocate a free physical frame in memory
+ * The search begins at the summary word holding lastallocatedframe, so consecutive
+ * allocations rotate through memory rather than rescanning the lowest frames every time.
+ * The DMA zone is only searched once every frame above it is taken
  * @return The physical address of the free frame
  */
 uint framealloc() {
-  uint i,j;
-  // Do a search over all frames in our frame table
-  for(i = 0; i < numframetableentries; i++) {
-    for(j = 0; j < 32; j++) {
-      // Check if the jth bit in the ith frame table entry is a 1
-      if(!((*(framelist + i) >> j) & 0x00000001)) {
-	// Mark the frame as occupied
-	*(framelist + i) |= (0x00000001 << j);
-	
-	return (uint) (framebaseaddr + ((i * 32) + j) * FRAME_SIZE);
+  uint dmasummaries = dmazoneframes / 1024;
+  uint frameaddr = allocrange(dmasummaries, numsummaryentries, (lastallocatedframe / 32) / 32);
+
+  if(frameaddr == SYSERR) {
+    frameaddr = allocrange(0, dmasummaries, 0);
+  }
+  if(frameaddr != SYSERR) {
+    return frameaddr;
+  }
+
+  // The only free frames left are waiting zeroed in the pool
+  if(zeropoolcount > 0) {
+    numfreeframes--;
+    return zeropool[--zeropoolcount];
+  }
+  // or in the large page kept for pageinlarge(), which is broken up for them
+  if(zerolarge != SYSERR) {
+    numfreeframes -= LARGE_FRAMES;
+    freeframe_n(zerolarge, LARGE_FRAMES);
+    zerolarge = SYSERR;
+    zerolargewanted = FALSE;
+    return framealloc();
+  }
+  return SYSERR;
+}
+
+/**
+ * Find and take a run of `nframes` free frames among frames [lo, hi), beginning the search at the
+ * bitmap word holding frame `start`. Both bounds are multiples of 1024
+ * Fully occupied and fully free bitmap words are stepped over 32 frames at a time,
+ * and fully occupied summary words 1024 frames at a time
+ * @return The physical address of the first frame in the run, or SYSERR if no run is long enough
+ */
+static uint findrun(uint nframes, uint lo, uint hi, uint start) {
+  uint frame, scanned, run, runstart;
+
+  if(nframes > hi - lo) {
+    return SYSERR;
+  }
+
+  // Search one lap past the start so runs crossing it are seen
+  frame = (start >= lo && start < hi) ? (start & ~31) : lo;
+  run = 0;
+  runstart = 0;
+  for(scanned = 0; scanned < (hi - lo) + nframes; ) {
+    if(frame >= hi) {
+      // Runs cannot wrap around the end of the range
+      frame = lo;
+      run = 0;
+    }
+
+    uint entry = frame / 32;
+
+    if(frame % 1024 == 0 && *(framesummary + entry / 32) == 0xFFFFFFFF) {
+      run = 0;
+      frame += 1024;
+      scanned += 1024;
+      continue;
+    }
+
+    if(frame % 32 == 0 && (*(framelist + entry) == 0xFFFFFFFF || *(framelist + entry) == 0)) {
+      if(*(framelist + entry) == 0xFFFFFFFF) {
+	run = 0;
+      } else {
+	if(run == 0) {
+	  runstart = frame;
+	}
+	run += 32;
+      }
+      frame += 32;
+      scanned += 32;
+    } else {
+      if(((*(framelist + entry) >> (frame % 32)) & 0x00000001) == 0) {
+	if(run == 0) {
+	  runstart = frame;
+	}
+	run++;
+      } else {
+	run = 0;
+      }
+      frame++;
+      scanned++;
+    }
+
+    if(run >= nframes) {
+      for(frame = runstart; frame < runstart + nframes; frame++) {
+	markframe(frame);
+      }
+      lastallocatedframe = runstart + nframes - 1;
+
+      return (uint) (framebaseaddr + runstart * FRAME_SIZE);
+    }
+  }
+  return SYSERR;
+}
+
+/**
+ * Allocate `nframes` physically contiguous free frames
+ * Runs are looked for above the DMA zone first, and in it only when there are none there
+ * @return The physical address of the first frame in the run, or SYSERR if no run is long enough
+ */
+uint framealloc_n(uint nframes) {
+  uint totalframes = numframetableentries * 32;
+
+  if(nframes == 0 || nframes > totalframes) {
+    return SYSERR;
+  }
+  if(nframes == 1) {
+    return framealloc();
+  }
+
+  uint frameaddr = findrun(nframes, dmazoneframes, totalframes, lastallocatedframe);
+  if(frameaddr == SYSERR) {
+    frameaddr = findrun(nframes, 0, dmazoneframes, 0);
+  }
+  return frameaddr;
+}
+
+/**
+ * Allocate LARGE_FRAMES free frames aligned to LARGE_PAGE_SIZE, to back a large page
+ * The aligned spans are exactly those described by one summary word, so a span is free when all
+ * 32 of its bitmap words are zero. The search starts from the lowest span above the DMA zone,
+ * and large pages never come from the DMA zone itself
+ * @return The physical address of the first frame, or SYSERR if no span is entirely free
+ */
+uint framealloc_large() {
+  uint summaryindex, entry, frame;
+
+  for(summaryindex = dmazoneframes / 1024; summaryindex < numsummaryentries; summaryindex++) {
+    if(*(framesummary + summaryindex) != 0) {
+      continue;
+    }
+    for(entry = summaryindex * 32; entry < summaryindex * 32 + 32; entry++) {
+      if(*(framelist + entry) != 0) {
+	break;
+      }
+    }
+    if(entry < summaryindex * 32 + 32) {
+      continue;
+    }
+
+    for(frame = summaryindex * 1024; frame < summaryindex * 1024 + LARGE_FRAMES; frame++) {
+      markframe(frame);
+    }
+    return (uint) (framebaseaddr + summaryindex * 1024 * FRAME_SIZE);
+  }
+  return SYSERR;
+}
+
+/**
+ * Allocate 4MB of contiguous frames, aligned to LARGE_PAGE_SIZE, which are already zeroed
+ * Only the large page the null thread keeps zeroed is handed out; asking for one when none is
+ * ready has the null thread prepare one instead, so callers fall back to 4KB pages meanwhile
+ * @return The physical address of the first frame, or SYSERR if no zeroed large page is ready
+ */
+uint framealloc_largezeroed() {
+  zerolargewanted = TRUE;
+  if(zerolarge == SYSERR || zerolargedone < LARGE_FRAMES) {
+    return SYSERR;
+  }
+
+  uint frameaddr = zerolarge;
+  zerolarge = SYSERR;
+  numfreeframes -= LARGE_FRAMES;
+  return frameaddr;
+}
+
+/**
+ * Reports whether a zeroed large page is ready for framealloc_largezeroed(), asking the null
+ * thread to prepare one if not
+ */
+bool framelargeready() {
+  zerolargewanted = TRUE;
+  return zerolarge != SYSERR && zerolargedone == LARGE_FRAMES;
+}
+
+/**
+ * Determines whether the `block` frames starting at frame `frame` are all free. The block is a
+ * power of two in size and aligned to it, so one of under 32 frames sits inside a single word
+ */
+static bool blockfree(uint frame, uint block) {
+  if(block < 32) {
+    uint mask = ((0x00000001 << block) - 1) << (frame % 32);
+    return (*(framelist + frame / 32) & mask) == 0;
+  }
+
+  uint entry;
+  for(entry = frame / 32; entry < (frame + block) / 32; entry++) {
+    if(*(framelist + entry) != 0) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
+/**
+ * Find and take `nframes` free frames among frames [lo, hi), at the lowest frame whose physical
+ * address is a multiple of `step` frames heading a free block of `block` frames
+ * @return The physical address of the first frame, or SYSERR if there is no such block
+ */
+static uint findblock(uint nframes, uint block, uint step, uint lo, uint hi) {
+  // Alignment is of the physical address, which frame numbers are offset from
+  uint base = framebaseaddr / FRAME_SIZE;
+  uint frame, i;
+
+  for(frame = ((lo + base + step - 1) & ~(step - 1)) - base; frame + block <= hi; frame += step) {
+    // A full summary word has no free block to offer; framebaseaddr is 4MB aligned, so the
+    // next word starts on a multiple of step
+    if(step < 1024 && *(framesummary + frame / 1024) == 0xFFFFFFFF) {
+      frame = (frame | 1023) + 1 - step;
+      continue;
+    }
+    if(blockfree(frame, block)) {
+      for(i = frame; i < frame + nframes; i++) {
+	markframe(i);
       }
+      return (uint) (framebaseaddr + frame * FRAME_SIZE);
     }
   }
   return SYSERR;
 }
 
+/**
+ * Allocate `nframes` physically contiguous frames for a device buffer, in the manner of a buddy
+ * allocator layered over the bitmap. The request is rounded up to a power of two sized block, which
+ * must be entirely free and is placed at the lowest address aligned to its size, or to `align`
+ * frames if that is larger. Only `nframes` of the block are taken, and they are returned with
+ * freeframe_n(). Placing blocks on their natural boundaries, lowest first, keeps the rest of the
+ * zone in large aligned pieces for later requests
+ * `zone` is FRAMEZONE_DMA to take frames only below dmazoneend, or FRAMEZONE_NORMAL to look above
+ * it first. The frames are not mapped anywhere; callers reach them with kmap() or pagemap()
+ * @return The physical address of the first frame, or SYSERR if no suitable block is free
+ */
+uint framealloc_contig(uint nframes, uint align, uint zone) {
+  uint totalframes = numframetableentries * 32;
+  uint block, step;
+
+  if(nframes == 0 || nframes > totalframes || zone >= NFRAMEZONES) {
+    return SYSERR;
+  }
+  for(block = 1; block < nframes; block <<= 1)
+    ;
+  for(step = block; step < align; step <<= 1)
+    ;
+
+  uint frameaddr = SYSERR;
+  if(zone == FRAMEZONE_NORMAL) {
+    frameaddr = findblock(nframes, block, step, dmazoneframes, totalframes);
+  }
+  if(frameaddr == SYSERR) {
+    frameaddr = findblock(nframes, block, step, 0, dmazoneframes);
+  }
+  return frameaddr;
+}
+
+/**
+ * Allocate a free physical frame filled with zeros
+ * The frame is popped from the zeroed pool if there is one there, and otherwise allocated and
+ * zeroed on the spot through a temporary mapping
+ * @return The physical address of the frame, or SYSERR if none is free
+ */
+uint framealloc_zeroed() {
+  if(zeropoolcount > 0) {
+    zeropoolhits++;
+    numfreeframes--;
+    return zeropool[--zeropoolcount];
+  }
+
+  zeropoolmisses++;
+  uint frameaddr = framealloc();
+  if(frameaddr == SYSERR) {
+    return SYSERR;
+  }
+  void *frame = kmap(frameaddr);
+  if(frame == NULL) {
+    freeframe(frameaddr);
+    return SYSERR;
+  }
+  bzero(frame, FRAME_SIZE);
+  kunmap(frame);
+
+  return frameaddr;
+}
+
+/**
+ * Zero one more frame of the large page kept for pageinlarge(), taking a large page first if
+ * none is held. Nothing is done until a large page has been asked for
+ * Interrupts must be disabled
+ * @return TRUE if a frame was zeroed
+ */
+static bool zerolargefill(void) {
+  if(!zerolargewanted) {
+    return FALSE;
+  }
+  if(zerolarge == SYSERR) {
+    zerolarge = framealloc_large();
+    if(zerolarge == SYSERR) {
+      return FALSE;
+    }
+    // The held large page still counts as free, as the pool does
+    numfreeframes += LARGE_FRAMES;
+    zerolargedone = 0;
+  }
+  if(zerolargedone == LARGE_FRAMES) {
+    return FALSE;
+  }
+
+  void *frame = kmap(zerolarge + zerolargedone * FRAME_SIZE);
+  if(frame == NULL) {
+    return FALSE;
+  }
+  bzero(frame, FRAME_SIZE);
+  kunmap(frame);
+  zerolargedone++;
+
+  return TRUE;
+}
+
+/**
+ * Zero one frame for the pool if it needs refilling, called from the null thread's idle loop
+ * Refilling starts once the pool drops below ZPOOL_LOW and carries on up to ZPOOL_HIGH, after which
+ * the large page kept for pageinlarge() is zeroed the same way. Only one
+ * frame is zeroed per call, with interrupts disabled so the kmap() slot is never held by a
+ * preempted null thread; threads which become ready meanwhile wait no longer than that
+ * @return TRUE if a frame was added to the pool, FALSE if there was nothing to do
+ */
+bool zeropoolfill() {
+  irqmask im = disable();
+
+  if(zeropoolcount < ZPOOL_LOW) {
+    zeropoolfilling = TRUE;
+  }
+  // Stop at the high watermark, or when every free frame is already in the pool
+  if(!zeropoolfilling || zeropoolcount >= ZPOOL_HIGH
+     || numfreeframes <= zeropoolcount + (zerolarge == SYSERR ? 0 : LARGE_FRAMES)) {
+    zeropoolfilling = FALSE;
+    bool filled = zerolargefill();
+    restore(im);
+    return filled;
+  }
+
+  uint frameaddr = framealloc();
+  if(frameaddr == SYSERR) {
+    restore(im);
+    return FALSE;
+  }
+  void *frame = kmap(frameaddr);
+  if(frame == NULL) {
+    freeframe(frameaddr);
+    restore(im);
+    return FALSE;
+  }
+  bzero(frame, FRAME_SIZE);
+  kunmap(frame);
+
+  zeropool[zeropoolcount++] = frameaddr;
+  // Frames in the pool still count as free
+  numfreeframes++;
+  restore(im);
+
+  return TRUE;
+}
+
+/**
+ * Measure how fragmented the free frames are
+ * Whole bitmap words which are free or full are stepped over 32 frames at a time
+ * Interrupts must be disabled so the bitmap holds still
+ */
+void framestat(struct framestat *stat) {
+  uint entry, bit, word, w, free, run = 0;
+
+  stat->free = 0;
+  stat->dmafree = 0;
+  stat->runs = 0;
+  stat->largestrun = 0;
+  stat->largespans = 0;
+
+  for(entry = 0; entry < numframetableentries; entry++) {
+    word = *(framelist + entry);
+    free = stat->free;
+    if(entry % 32 == 0 && *(framesummary + entry / 32) == 0) {
+      // A span is free only if none of its words has a frame in use
+      for(w = entry; w < entry + 32 && *(framelist + w) == 0; w++)
+	;
+      if(w == entry + 32) {
+	stat->largespans++;
+      }
+    }
+
+    if(word == 0) {
+      // The whole word is free, so the run carries on through it
+      if(run == 0) {
+	stat->runs++;
+      }
+      run += 32;
+      stat->free += 32;
+    } else if(word == 0xFFFFFFFF) {
+      run = 0;
+    } else {
+      for(bit = 0; bit < 32; bit++) {
+	if((word >> bit) & 0x00000001) {
+	  if(run > stat->largestrun) {
+	    stat->largestrun = run;
+	  }
+	  run = 0;
+	} else {
+	  if(run == 0) {
+	    stat->runs++;
+	  }
+	  run++;
+	  stat->free++;
+	}
+      }
+    }
+    if(run > stat->largestrun) {
+      stat->largestrun = run;
+    }
+    if(entry < dmazoneframes / 32) {
+      stat->dmafree += stat->free - free;
+    }
+  }
+}
+
 /**
  * Mark a frame as free
+ * If the frame is shared, this only drops one reference and the frame stays allocated
  *
  */
 void freeframe(uint frameaddr) {
-  if(frameaddr >= framebaseaddr && frameaddr <= framebaseaddr + (numframetableentries * FRAME_SIZE)) {
+  if(frameaddr >= framebaseaddr && frameaddr < framebaseaddr + (numframetableentries * 32 * FRAME_SIZE)) {
     int entry = ((frameaddr - framebaseaddr) / FRAME_SIZE) / 32;
     int bit = ((frameaddr - framebaseaddr) / FRAME_SIZE) % 32;
-    *(framelist + entry) &= ~(0x00000001 << bit);
+
+    if(*(framerefs + entry * 32 + bit) > 0) {
+      *(framerefs + entry * 32 + bit) -= 1;
+      return;
+    }
+
+    if((*(framelist + entry) >> bit) & 0x00000001) {
+      *(framelist + entry) &= ~(0x00000001 << bit);
+      // The word now has at least one free frame, so it can't be marked full in the summary
+      *(framesummary + entry / 32) &= ~(0x00000001 << (entry % 32));
+      numfreeframes++;
+    }
+  }
+}
+
+/**
+ * Mark `nframes` contiguous frames beginning at `frameaddr` as free
+ *
+ */
+void freeframe_n(uint frameaddr, uint nframes) {
+  uint i;
+  for(i = 0; i < nframes; i++) {
+    freeframe(frameaddr + i * FRAME_SIZE);
+  }
+}
+
+/**
+ * Add a reference to an allocated frame which is about to be mapped a second time
+ * Each added reference is dropped by one call to freeframe()
+ * @return OK, or SYSERR if the frame is not allocated or its count is saturated
+ */
+syscall frameref(uint frameaddr) {
+  if(frameaddr < framebaseaddr || frameaddr >= framebaseaddr + (numframetableentries * 32 * FRAME_SIZE)) {
+    return SYSERR;
   }
+
+  uint frame = (frameaddr - framebaseaddr) / FRAME_SIZE;
+  if(!((*(framelist + frame / 32) >> (frame % 32)) & 0x00000001) || *(framerefs + frame) == 0xFF) {
+    return SYSERR;
+  }
+  *(framerefs + frame) += 1;
+
+  return OK;
+}
+
+/**
+ * Count the mappings of an allocated frame
+ * @return The number of references held on the frame, or 0 if it is free
+ */
+uint framerefcount(uint frameaddr) {
+  if(frameaddr < framebaseaddr || frameaddr >= framebaseaddr + (numframetableentries * 32 * FRAME_SIZE)) {
+    return 0;
+  }
+
+  uint frame = (frameaddr - framebaseaddr) / FRAME_SIZE;
+  if(!((*(framelist + frame / 32) >> (frame % 32)) & 0x00000001)) {
+    return 0;
+  }
+
+  return *(framerefs + frame) + 1;
 }
 
 /**
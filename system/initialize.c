@@ -19,6 +19,7 @@
 #include <queue.h>
 #include <semaphore.h>
 #include <monitor.h>
+#include <shm.h>
 #include <mailbox.h>
 #include <network.h>
 #include <nvram.h>
@@ -30,6 +31,7 @@
 #include <platform.h>
 #include <framealloc.h>
 #include <paging.h>
+#include <trace.h>
 
 #include <stdlib.h>
 
@@ -45,6 +47,7 @@ static int sysinit(void);       /* intializes system structures        */
 struct thrent thrtab[NTHREAD];  /* Thread table                   */
 struct sement semtab[NSEM];     /* Semaphore table                */
 struct monent montab[NMON];     /* Monitor table                  */
+struct shment shmtab[NSHM];     /* Shared memory segment table    */
 qid_typ readylist;              /* List of READY threads          */
 struct memblock memlist;        /* List of free memory blocks     */
 struct bfpentry bfptab[NPOOL];  /* List of memory buffer pools    */
@@ -83,7 +86,9 @@ void nulluser(void)
     /* Enable interrupts  */
     enable();
 
-    kprintf("Gonna spawn mah new thread\n");
+    /* Spawn the reaper, which frees the memory of killed threads  */
+    ready(create(reaper, INITSTK, REAPPRIO, "REAPER", 0), RESCHED_NO);
+
     /* Spawn the main thread  */
     //ready(create(main, INITSTK, INITPRIO, "MAIN", 0), RESCHED_YES);
     // Spawn a test thread to figure out these paging issues
@@ -93,6 +98,11 @@ void nulluser(void)
     while (TRUE)
     {
       
+        /* Zero frames for the pool while there is nothing else to do */
+        if (zeropoolfill())
+        {
+            continue;
+        }
 #ifndef DEBUG
         pause();
 #endif                          /* DEBUG */
@@ -127,17 +137,33 @@ static int sysinit(void)
   initpagetable(nullthreadpagedir);
   // Map the last entry of the directory to itself
   *(nullthreadpagedir + 1023) = (uint)nullthreadpagedir | 3;
-  kernelidentitytable = (uint*)framealloc();
-  initpagetable(kernelidentitytable);
 
-  // File kernelidentitytable with identity mappings over kernelspace
-  int j;
-  for(j = 0; (j * 0x1000) < USERSPACE_BASE; j++) {
-    *(kernelidentitytable + j) = (j * 0x1000) | 3;
+  // The kernel space is identity mapped by one large page where the CPU has them, and by
+  // kernelidentitytable otherwise.  Either way the mapping is the same in every page directory,
+  // so it is marked global
+  largepages = enablelargepages();
+  if(largepages) {
+    kernelidentitytable = NULL;
+    kernelpde = KERNELSPACE_BASE | PAGE_LARGE | PAGE_GLOBAL | 3;
+  } else {
+    kernelidentitytable = (uint*)framealloc();
+    initpagetable(kernelidentitytable);
+
+    // File kernelidentitytable with identity mappings over kernelspace
+    int j;
+    for(j = 0; (j * 0x1000) < KERNELSPACE_END; j++) {
+      *(kernelidentitytable + j) = (j * 0x1000) | PAGE_GLOBAL | 3;
+    }
+    kernelpde = (uint)kernelidentitytable | 3;
   }
 
-  // Place kernel identity table in kernel's page directory
-  *(nullthreadpagedir + 0) = (uint)kernelidentitytable | 3;
+  // The kmap() slots start out not present
+  kmaptable = (uint*)framealloc();
+  initpagetable(kmaptable);
+
+  // Place kernel mappings in kernel's page directory
+  *(nullthreadpagedir + 0) = kernelpde;
+  *(nullthreadpagedir + (KMAP_BASE >> 22)) = (uint)kmaptable | 3;
   
   // Attempt to log info about x86_64 control registers
   uint cr0, cr2, cr3, cr4;
@@ -154,16 +180,13 @@ static int sysinit(void)
 			:
 			: "%eax"
 			);
-  kprintf("cr0= 0x%8.8X\n", cr0);
-  kprintf("cr2= 0x%8.8X\n", cr2);
-  kprintf("cr3= 0x%8.8X\n", cr3);
-  kprintf("cr4= 0x%8.8X\n", cr4);
+  PAGING_TRACE("Before paging: cr0=0x%08X cr2=0x%08X cr3=0x%08X cr4=0x%08X", cr0, cr2, cr3, cr4);
 
   loadCR3(nullthreadpagedir);
   enablepaging();
+  enableglobalpages();
   
   
-  kprintf("Tried to enable paging\n\n");
     __asm__ __volatile__ (
 			"mov %%cr0, %%eax\n\t"
 			"mov %%eax, %0\n\t"
@@ -177,13 +200,9 @@ static int sysinit(void)
 			:
 			: "%eax"
 			);
-  kprintf("cr0= 0x%8.8X\n", cr0);
-  kprintf("cr2= 0x%8.8X\n", cr2);
-  kprintf("cr3= 0x%8.8X\n", cr3);
-  kprintf("cr4= 0x%8.8X\n", cr4);
+  PAGING_TRACE("After paging: cr0=0x%08X cr2=0x%08X cr3=0x%08X cr4=0x%08X", cr0, cr2, cr3, cr4);
 
-  kprintf("End: 0x%8.8X\n", (ulong)&_end);
-  kprintf("memheap: 0x%8.8X\n", memheap);
+  PAGING_TRACE("End: 0x%08X, memheap: 0x%08X", (ulong)&_end, memheap);
 
     int i;
     struct thrent *thrptr;      /* thread control block pointer  */
@@ -197,10 +216,11 @@ static int sysinit(void)
     // I don't think I need any of this but we'll leave it for now just in case
     memheap = roundmb(memheap);
     platform.maxaddr = truncmb(platform.maxaddr);
+    // Once paging is on, only the identity mapped region below the kmap() slots is reachable
     memlist.next = pmblock = (struct memblock *)memheap;
-    memlist.length = (uint)(platform.maxaddr - memheap);
+    memlist.length = (uint)KMAP_BASE - (uint)memheap;
     pmblock->next = NULL;
-    pmblock->length = (uint)(platform.maxaddr - memheap);
+    pmblock->length = (uint)KMAP_BASE - (uint)memheap;
 
     /* Initialize thread table */
     for (i = 0; i < NTHREAD; i++)
@@ -212,6 +232,9 @@ static int sysinit(void)
     thrptr = &thrtab[NULLTHREAD];
     thrptr->state = THRCURR;
     thrptr->prio = 0;
+    thrptr->baseprio = 0;
+    thrptr->monwait = NOMON;
+    thrptr->msgqmax = 0;
     strlcpy(thrptr->name, "prnull", TNMLEN);
     thrptr->pagedir = nullthreadpagedir;
 
@@ -219,24 +242,28 @@ static int sysinit(void)
     // Essentially just a copy of some of the work done in create.c
 
     // 0x10000 is the normal kernel stack size in x86 xinu
-    thrptr->stkbase = (void *) (USERSPACE_END - 0x10000);
+    // The null thread really runs on the boot stack, so its user stack region is only paged in if touched
+    thrptr->stkbase = (void *) (USERSPACE_END - sizeof(ulong));
     thrptr->stklen = 0x10000;
-    // Give it an extra frame below the stack for when it initializes the stackx
-    pageregion(USERSPACE_END - 0x21000, USERSPACE_END - 1);
     thrptr->stkptr = 0;
+    thrptr->pgfaults = 0;
+    thrptr->untrimmed = 0;
+    thrptr->stkpeak = 0;
     // Setup memlist stuff
     // First, create the memblock for the thread->memlist
     // This is a bad hack, but gcc's giving me type issues otherwise
-    pageregion(USERSPACE_BASE, USERSPACE_BASE + 0x1000);
+    thrptr->rss = pageregion(USERSPACE_BASE, USERSPACE_BASE + 0x1000);
     uint *memlisteditor = (uint*) &(thrptr->memlist);
     *memlisteditor = USERSPACE_BASE;
     // Now, create the memblock for the first memblock
     struct memblock *memlistnext = (struct memblock*)(USERSPACE_BASE + sizeof(struct memblock));
     // Initialize those data structures
     memlistnext->next = NULL;
-    memlistnext->length = USERSPACE_END - sizeof(struct memblock) * 2;
+    // The heap starts out HEAP_CHUNK long, as for created threads
+    memlistnext->length = HEAP_CHUNK - sizeof(struct memblock);
     thrptr->memlist.next = memlistnext;
-    thrptr->memlist.length = USERSPACE_END - sizeof(struct memblock) * 2;
+    thrptr->memlist.length = memlistnext->length;
+    thrptr->brk = USERSPACE_BASE + HEAP_CHUNK;
       
     thrcurrent = NULLTHREAD;
 
@@ -253,6 +280,12 @@ static int sysinit(void)
         montab[i].state = MFREE;
     }
 
+    /* Initialize shared memory segments */
+    for (i = 0; i < NSHM; i++)
+    {
+        shmtab[i].state = SHMFREE;
+    }
+
     /* Initialize buffer pools */
     for (i = 0; i < NPOOL; i++)
     {
@@ -260,7 +293,7 @@ static int sysinit(void)
     }
 
     /* initialize thread ready list */
-    readylist = queinit();
+    readyinit();
 
 #if SB_BUS
     backplaneInit(NULL);
@@ -327,6 +360,5 @@ static int sysinit(void)
     // All this really does is just turn on an LED though :p
     //gpioLEDOn(GPIO_LED_CISCOWHT);
 #endif
-    kprintf("Got to the end of initialize.c\n");
     return OK;
 }
@@ -6,9 +6,13 @@
 
 #include <thread.h>
 #include <queue.h>
+#include <monitor.h>
+#include <mailbox.h>
 #include <memory.h>
 #include <safemem.h>
 #include <paging.h>
+#include <trace.h>
+#include <critical.h>
 
 extern void xdone(void);
 
@@ -24,15 +28,16 @@ syscall kill(tid_typ tid)
     register struct thrent *thrptr;     /* thread control block */
     irqmask im;
 
-    im = disable();
+    im = CS_DISABLE();
     if (isbadtid(tid) || (NULLTHREAD == tid))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
     thrptr = &thrtab[tid];
 
-    if (--thrcount <= 1)
+    /* The null thread and the reaper run forever */
+    if (--thrcount <= (isbadtid(reapertid) ? 1 : 2))
     {
         xdone();
     }
@@ -42,16 +47,32 @@ syscall kill(tid_typ tid)
     memRegionReclaim(tid);
 #endif                          /* UHEAP_SIZE */
 
-    // Reclaim allocated frames
-    reclaimframes(thrptr->pagedir);
+    THREAD_TRACE("Killing thread %d, %s", tid, thrptr->name);
 
+    // Reclaim allocated frames, usually left to the reaper thread so kill() returns quickly.
+    // Until then the directory stays intact, which a suicide keeps running on until resched()
+    reap(thrptr->pagedir, thrptr->ptmap);
+
+    // The stack lives in the dying thread's address space, so it goes along with the rest
     send(thrptr->parent, tid);
 
-    stkfree(thrptr->stkbase, thrptr->stklen);
+    /* Wake any threads waiting for room to send to this one */
+    if (thrptr->msgqmax > 0)
+    {
+        semfree(thrptr->msgqroom);
+        thrptr->msgqmax = 0;
+    }
+
+#if NMAILBOX
+    /* Free the mailboxes it was selecting on, woken or not */
+    mailboxUnselect(tid);
+#endif
 
     switch (thrptr->state)
     {
     case THRSLEEP:
+    case THRTMOUT:
+    case THRMBOX:
         unsleep(tid);
         thrptr->state = THRFREE;
         break;
@@ -60,7 +81,17 @@ syscall kill(tid_typ tid)
         resched();
 
     case THRWAIT:
+        /* a waittime() caller's timer must not fire for a dead thread */
+        tmcancel(&thrptr->timer);
         semtab[thrptr->sem].count++;
+        if (NOMON != thrptr->monwait)
+        {
+            /* the owner no longer inherits from this thread */
+            getitem(tid);
+            thrptr->state = THRFREE;
+            moninherit(montab[thrptr->monwait].owner);
+            break;
+        }
 
     case THRREADY:
         getitem(tid);           /* removes from queue */
@@ -69,6 +100,6 @@ syscall kill(tid_typ tid)
         thrptr->state = THRFREE;
     }
 
-    restore(im);
+    CS_RESTORE(im);
     return OK;
 }
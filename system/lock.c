@@ -4,6 +4,8 @@
 /* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
 
 #include <monitor.h>
+#include <queue.h>
+#include <critical.h>
 
 /**
  * @ingroup monitors
@@ -17,8 +19,9 @@
  * no further action is taken.
  *
  * If another thread owns the monitor, the current thread waits for the monitor
- * to become fully unlocked by that thread, then sets its owner to the current
- * thread and its count to 1.
+ * to become fully unlocked by that thread, which hands it the monitor with a
+ * count of 1.  Waiters are queued by priority, and the owner inherits the
+ * priority of the highest waiter until it unlocks; see moninherit().
  *
  * @param mon
  *      The monitor to lock.
@@ -30,12 +33,14 @@
 syscall lock(monitor mon)
 {
     struct monent *monptr;
+    struct sement *semptr;
+    struct thrent *thrptr;
     irqmask im;
 
-    im = disable();
+    im = CS_DISABLE();
     if (isbadmon(mon))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
 
@@ -47,6 +52,10 @@ syscall lock(monitor mon)
         monptr->owner = thrcurrent;     /* current thread now owns the lock  */
         (monptr->count)++;      /* add 1 "lock" to the monitor's count */
         wait(monptr->sem);      /* this thread owns the semaphore      */
+        if (monptr->ceiling > thrtab[thrcurrent].prio)
+        {
+            moninherit(thrcurrent);
+        }
     }
     else
     {
@@ -55,16 +64,22 @@ syscall lock(monitor mon)
         {
             (monptr->count)++;
         }
-        /* if another thread owns the lock, wait on sem until monitor is free */
+        /* if another thread owns the lock, wait on sem in priority order
+         * and lend the owner our priority until unlock() hands it over */
         else
         {
-            wait(monptr->sem);
-            monptr->owner = thrcurrent;
-            (monptr->count)++;
-
+            semptr = &semtab[monptr->sem];
+            thrptr = &thrtab[thrcurrent];
+            (semptr->count)--;
+            thrptr->state = THRWAIT;
+            thrptr->sem = monptr->sem;
+            thrptr->monwait = mon;
+            insert(thrcurrent, semptr->queue, thrptr->prio);
+            moninherit(monptr->owner);
+            resched();
         }
     }
 
-    restore(im);
+    CS_RESTORE(im);
     return OK;
 }
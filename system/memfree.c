@@ -4,10 +4,12 @@
  */
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
-#include <platform.h>
 #include <memory.h>
 #include <interrupt.h>
+#include <paging.h>
 #include <thread.h>
+#include <trace.h>
+#include <critical.h>
 
 /**
  * @ingroup memory_mgmt
@@ -23,6 +25,13 @@
  * @return
  *      ::OK on success; ::SYSERR on failure.  This function can only fail
  *      because of memory corruption or specifying an invalid memory block.
+ *
+ * Blocks of up to ::SLAB_MAXSIZE bytes go back to the thread's slab free list
+ * for their size class in constant time.  Larger blocks are coalesced into
+ * the thread's memlist; if the result is at least ::MEMTRIM_BYTES long the
+ * frames behind it are released at once, otherwise they are left for the
+ * next memtrim().  A block that long at the top of the heap has memtrim()
+ * lower the break over it straight away.
  */
 syscall memfree(void *memptr, uint nbytes)
 {
@@ -31,21 +40,29 @@ syscall memfree(void *memptr, uint nbytes)
     ulong top;
     struct thrent *thread;
 
+    // Setup thread pointer
+    thread = &thrtab[thrcurrent];
+
     /* make sure block is in heap */
     if ((0 == nbytes)
-        || ((ulong)memptr < (ulong)memheap)
-        || ((ulong)memptr > (ulong)platform.maxaddr))
+        || ((ulong)memptr < USERSPACE_BASE)
+        || ((ulong)memptr >= thread->brk)
+        || (nbytes > thread->brk - (ulong)memptr))
     {
         return SYSERR;
     }
 
-    // Setup thread pointer
-    thread = &thrtab[thrcurrent];
-
     block = (struct memblock *)memptr;
     nbytes = (ulong)roundmb(nbytes);
 
-    im = disable();
+    if (nbytes <= SLAB_MAXSIZE)
+    {
+        slabfree(memptr, nbytes);
+        MEM_TRACE("memfree %u bytes at 0x%08X", nbytes, memptr);
+        return OK;
+    }
+
+    im = CS_DISABLE();
 
     prev = &(thread->memlist);
     next = thread->memlist.next;
@@ -56,7 +73,7 @@ syscall memfree(void *memptr, uint nbytes)
     }
 
     /* find top of previous memblock */
-    if (prev == &memlist)
+    if (prev == &(thread->memlist))
     {
         top = NULL;
     }
@@ -69,7 +86,7 @@ syscall memfree(void *memptr, uint nbytes)
     if ((top > (ulong)block)
         || ((next != NULL) && ((ulong)block + nbytes) > (ulong)next))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
 
@@ -94,6 +111,27 @@ syscall memfree(void *memptr, uint nbytes)
         block->length += next->length;
         block->next = next->next;
     }
-    restore(im);
+    MEM_TRACE("memfree %u bytes at 0x%08X", nbytes, memptr);
+
+    if ((block->length >= HEAP_CHUNK)
+        && ((ulong)block + block->length == thread->brk))
+    {
+        memtrim();
+    }
+    else if (block->length >= MEMTRIM_BYTES)
+    {
+        thread->rss -= pagerelease((uint)block + sizeof(struct memblock),
+                                   (uint)block + block->length);
+    }
+    else
+    {
+        thread->untrimmed += nbytes;
+        if (thread->untrimmed >= MEMTRIM_BYTES)
+        {
+            memtrim();
+        }
+    }
+
+    CS_RESTORE(im);
     return OK;
 }
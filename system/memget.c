@@ -9,6 +9,10 @@
 #include <stdio.h>
 #include <paging.h>
 #include <thread.h>
+#include <trace.h>
+#include <critical.h>
+
+static syscall heapgrow(struct thrent *, uint);
 
 /**
  * @ingroup memory_mgmt
@@ -23,6 +27,10 @@
  *      request; otherwise returns a pointer to the allocated memory region.
  *      The returned pointer is guaranteed to be 8-byte aligned.  Free the block
  *      with memfree() when done with it.
+ *
+ * Requests of up to ::SLAB_MAXSIZE bytes are served in constant time from the
+ * thread's slab free lists; larger ones take the first fit from its memlist.
+ * When nothing fits, the thread's break is raised to make room.
  */
 void *memget(uint nbytes)
 {  
@@ -41,36 +49,114 @@ void *memget(uint nbytes)
     /* round to multiple of memblock size   */
     nbytes = (ulong)roundmb(nbytes);
 
-    im = disable();
-
-    prev = &(thread->memlist);
-    curr = thread->memlist.next;
-    while (curr != NULL)
+    if (nbytes <= SLAB_MAXSIZE)
     {
-        if (curr->length == nbytes)
+        curr = slabget(nbytes);
+        if (SYSERR != (int)curr)
         {
-            prev->next = curr->next;
-            thread->memlist.length -= nbytes;
-
-            restore(im);
-            return (void *)(curr);
+            MEM_TRACE("memget %u bytes at 0x%08X", nbytes, curr);
+            return (void *)curr;
         }
-        else if (curr->length > nbytes)
+        /* No room for a new slab; take just this object from the memlist,
+         * in its class size, since memfree() returns it to the slab */
+        nbytes = slabsize(nbytes);
+    }
+
+    im = CS_DISABLE();
+
+    do
+    {
+        prev = &(thread->memlist);
+        curr = thread->memlist.next;
+        while (curr != NULL)
         {
-  	    pageregion((uint)curr, (uint)(curr + nbytes));
-            /* split block into two */
-            leftover = (struct memblock *)((ulong)curr + nbytes);
-            prev->next = leftover;
-            leftover->next = curr->next;
-            leftover->length = curr->length - nbytes;
-            thread->memlist.length -= nbytes;
-
-            restore(im);
-            return (void *)(curr);
+            if (curr->length == nbytes)
+            {
+                prev->next = curr->next;
+                thread->memlist.length -= nbytes;
+
+                MEM_TRACE("memget %u bytes at 0x%08X", nbytes, curr);
+                CS_RESTORE(im);
+                return (void *)(curr);
+            }
+            else if (curr->length > nbytes)
+            {
+                /* split block into two */
+                leftover = (struct memblock *)((ulong)curr + nbytes);
+                // Only back the leftover's header; the rest is paged in on demand
+                thread->rss += pageregion((uint)leftover,
+                                          (uint)leftover + sizeof(struct memblock) - 1);
+                prev->next = leftover;
+                leftover->next = curr->next;
+                leftover->length = curr->length - nbytes;
+                thread->memlist.length -= nbytes;
+
+                MEM_TRACE("memget %u bytes at 0x%08X", nbytes, curr);
+                CS_RESTORE(im);
+                return (void *)(curr);
+            }
+            prev = curr;
+            curr = curr->next;
         }
-        prev = curr;
-        curr = curr->next;
     }
-    restore(im);
+    while (OK == heapgrow(thread, nbytes));
+
+    CS_RESTORE(im);
     return (void *)SYSERR;
 }
+
+/*
+ * Raise the thread's break so that a block of nbytes fits at the top of its
+ * heap, in multiples of HEAP_CHUNK, and put the new memory on the memlist.
+ * A free block ending at the old break is extended, so only the shortfall
+ * is added.  Interrupts must be disabled.
+ */
+static syscall heapgrow(struct thrent *thread, uint nbytes)
+{
+    struct memblock *last, *block;
+    uint oldbrk, grow;
+
+    oldbrk = thread->brk;
+
+    /* The memlist is sorted, so the last block is the highest */
+    last = &(thread->memlist);
+    while (NULL != last->next)
+    {
+        last = last->next;
+    }
+    if ((last != &(thread->memlist))
+        && ((uint)last + last->length == oldbrk))
+    {
+        nbytes -= last->length;
+    }
+
+    if (nbytes > USERSPACE_END - oldbrk)
+    {
+        return SYSERR;
+    }
+    grow = (nbytes + HEAP_CHUNK - 1) & ~(HEAP_CHUNK - 1);
+    if ((grow < nbytes) || (SYSERR == brk((void *)(oldbrk + grow))))
+    {
+        return SYSERR;
+    }
+
+    if ((last != &(thread->memlist))
+        && ((uint)last + last->length == oldbrk))
+    {
+        last->length += grow;
+    }
+    else
+    {
+        block = (struct memblock *)oldbrk;
+        // Back the new block's header, which is written straight away
+        thread->rss += pageregion((uint)block,
+                                  (uint)block + sizeof(struct memblock) - 1);
+        block->next = NULL;
+        block->length = grow;
+        last->next = block;
+    }
+    thread->memlist.length += grow;
+
+    MEM_TRACE("heap grown by %u bytes to 0x%08X", grow, thread->brk);
+    return OK;
+}
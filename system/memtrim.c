@@ -0,0 +1,75 @@
+/**
+ * @file memtrim.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <framealloc.h>
+#include <memory.h>
+#include <paging.h>
+#include <thread.h>
+#include <trace.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Returns the frames behind free heap memory to the frame allocator.  Every
+ * page lying wholly inside the body of a block on the current thread's
+ * memlist is unmapped; block headers stay resident since memget() and
+ * memfree() write them.  An unmapped page is backed again on demand if the
+ * memory is reallocated and touched.  A free block of at least
+ * ::HEAP_CHUNK at the top of the heap is given up altogether by lowering the
+ * break to the first page boundary inside it.
+ *
+ * memfree() calls this once ::MEMTRIM_BYTES have been freed without being
+ * released, or when it frees a large block at the top of the heap.
+ *
+ * @return
+ *      ::OK
+ */
+syscall memtrim(void)
+{
+    register struct memblock *block, *prev;
+    irqmask im;
+    struct thrent *thread;
+    uint released = 0;
+    uint top;
+
+    thread = &thrtab[thrcurrent];
+
+    im = disable();
+    prev = &(thread->memlist);
+    for (block = thread->memlist.next; block != NULL; block = block->next)
+    {
+        released += pagerelease((uint)block + sizeof(struct memblock),
+                                (uint)block + block->length);
+        if (NULL != block->next)
+        {
+            prev = block;
+        }
+    }
+    thread->rss -= released;
+    thread->untrimmed = 0;
+
+    /* prev->next is now the highest free block, if there is one */
+    block = prev->next;
+    if ((NULL != block) && (block->length >= HEAP_CHUNK)
+        && ((uint)block + block->length == thread->brk))
+    {
+        top = truncframe((uint)block + FRAME_SIZE - 1);
+        thread->memlist.length -= thread->brk - top;
+        if (top == (uint)block)
+        {
+            prev->next = NULL;
+        }
+        else
+        {
+            block->length = top - (uint)block;
+        }
+        brk((void *)top);
+    }
+    MEM_TRACE("memtrim released %u pages", released);
+    restore(im);
+    return OK;
+}
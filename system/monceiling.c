@@ -0,0 +1,49 @@
+/**
+ * @file monceiling.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <monitor.h>
+
+/**
+ * @ingroup monitors
+ *
+ * Set the priority ceiling of a monitor.
+ *
+ * While a thread owns a monitor with a ceiling, it runs at no less than the
+ * ceiling, whether or not any thread is waiting.  Setting the ceiling to the
+ * highest priority of the threads which lock the monitor keeps any of them
+ * from preempting the owner in its critical section.
+ *
+ * @param mon
+ *      The monitor to change.
+ * @param prio
+ *      The new ceiling, or 0 for none.
+ *
+ * @return
+ *      ::OK on success; ::SYSERR on failure (@p mon did not specify a valid,
+ *      allocated monitor).
+ */
+syscall monceiling(monitor mon, int prio)
+{
+    struct monent *monptr;
+    irqmask im;
+
+    im = disable();
+    if (isbadmon(mon))
+    {
+        restore(im);
+        return SYSERR;
+    }
+
+    monptr = &montab[mon];
+    monptr->ceiling = prio;
+    if (NOOWNER != monptr->owner)
+    {
+        moninherit(monptr->owner);
+        resched();
+    }
+
+    restore(im);
+    return OK;
+}
@@ -32,9 +32,10 @@ monitor moncreate(void)
     {
         monptr = &montab[mon];
 
-        /* Monitors initially have no owner and zero count.  */
+        /* Monitors initially have no owner, zero count and no ceiling.  */
         monptr->owner = NOOWNER;
         monptr->count = 0;
+        monptr->ceiling = 0;
 
         /* Initialize the monitor's semaphore with a count of 1, allowing one
          * thread to acquire the monitor.  */
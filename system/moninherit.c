@@ -0,0 +1,84 @@
+/**
+ * @file moninherit.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <monitor.h>
+#include <queue.h>
+
+/**
+ * @ingroup monitors
+ *
+ * Recompute the priority of a thread from the monitors it owns.
+ *
+ * A thread runs at the highest of its own priority, the ceilings of the
+ * monitors it owns, and the priorities of the threads waiting to lock them,
+ * so a low priority owner cannot be held off by medium priority threads
+ * while a high priority thread waits.  If the thread is itself waiting to
+ * lock a monitor, the change is passed along to that monitor's owner.
+ *
+ * A ready thread is moved to the ready queue for its new priority, and a
+ * waiting thread is moved within its semaphore queue, which lock() keeps in
+ * priority order.  Interrupts must be disabled.
+ *
+ * @param tid
+ *      The thread whose priority to recompute.
+ */
+void moninherit(tid_typ tid)
+{
+    struct thrent *thrptr;
+    struct monent *monptr;
+    qid_typ q;
+    int prio, i, depth;
+
+    /* A cycle of owners is a deadlock, but must not hang the kernel */
+    for (depth = 0; depth < NTHREAD && !isbadtid(tid); depth++)
+    {
+        thrptr = &thrtab[tid];
+        prio = thrptr->baseprio;
+        for (i = 0; i < NMON; i++)
+        {
+            monptr = &montab[i];
+            if ((MUSED != monptr->state) || (tid != monptr->owner))
+            {
+                continue;
+            }
+            if (monptr->ceiling > prio)
+            {
+                prio = monptr->ceiling;
+            }
+            q = semtab[monptr->sem].queue;
+            if (nonempty(q) && (firstkey(q) > prio))
+            {
+                prio = firstkey(q);
+            }
+        }
+
+        if (prio == thrptr->prio)
+        {
+            return;
+        }
+        thrptr->prio = prio;
+
+        switch (thrptr->state)
+        {
+        case THRREADY:
+            getitem(tid);
+            readyinsert(tid, prio);
+            return;
+
+        case THRWAIT:
+            if (NOMON == thrptr->monwait)
+            {
+                return;
+            }
+            getitem(tid);
+            insert(tid, semtab[thrptr->sem].queue, prio);
+            tid = montab[thrptr->monwait].owner;
+            break;
+
+        default:
+            return;
+        }
+    }
+}
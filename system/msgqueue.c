@@ -0,0 +1,123 @@
+/**
+ * @file msgqueue.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <thread.h>
+
+/**
+ * @ingroup threads
+ *
+ * Give a thread a ring of messages in place of its single message slot, so
+ * bursts of send() are queued rather than refused.  Usually called between
+ * create() and ready(); a message already waiting moves into the ring.
+ * @param tid thread to receive the messages
+ * @param nmsgs messages the ring holds, at most MSGQLEN
+ * @return OK on success, SYSERR if the thread is invalid, already has a
+ *         ring, nmsgs is out of range, or no semaphore is left
+ */
+syscall msgqueue(tid_typ tid, uint nmsgs)
+{
+    register struct thrent *thrptr;
+    irqmask im;
+    semaphore room;
+
+    im = disable();
+    if (isbadtid(tid) || (0 == nmsgs) || (nmsgs > MSGQLEN))
+    {
+        restore(im);
+        return SYSERR;
+    }
+    thrptr = &thrtab[tid];
+    if (thrptr->msgqmax > 0)
+    {
+        restore(im);
+        return SYSERR;
+    }
+
+    room = semcreate(thrptr->hasmsg ? nmsgs - 1 : nmsgs);
+    if (SYSERR == room)
+    {
+        restore(im);
+        return SYSERR;
+    }
+    thrptr->msgqroom = room;
+    thrptr->msgqhead = 0;
+    thrptr->msgqcount = 0;
+    if (thrptr->hasmsg)
+    {
+        thrptr->msgq[0] = thrptr->msg;
+        thrptr->msgqcount = 1;
+    }
+    thrptr->msgqmax = nmsgs;
+    restore(im);
+    return OK;
+}
+
+/**
+ * @ingroup threads
+ *
+ * Store a message for a thread and start the thread if it is waiting for
+ * one.  The caller has checked there is room, and interrupts must be
+ * disabled.
+ * @param tid thread id of recipient
+ * @param msg contents of message
+ */
+void msgdeposit(tid_typ tid, message msg)
+{
+    register struct thrent *thrptr;
+
+    thrptr = &thrtab[tid];
+    if (0 == thrptr->msgqmax)
+    {
+        thrptr->msg = msg;      /* deposit message                */
+    }
+    else
+    {
+        thrptr->msgq[(thrptr->msgqhead + thrptr->msgqcount)
+                     % thrptr->msgqmax] = msg;
+        thrptr->msgqcount++;
+    }
+    thrptr->hasmsg = TRUE;      /* raise message flag             */
+
+    /* if receiver waits, start it */
+    if (THRRECV == thrptr->state)
+    {
+        ready(tid, RESCHED_YES);
+    }
+    else if (THRTMOUT == thrptr->state)
+    {
+        unsleep(tid);
+        ready(tid, RESCHED_YES);
+    }
+}
+
+/**
+ * @ingroup threads
+ *
+ * Remove the oldest message waiting for a thread, letting a sender blocked
+ * in sendwait() store another.  The thread must have a message, and
+ * interrupts must be disabled.
+ * @param thrptr thread entry of the recipient
+ * @return the message
+ */
+message msgtake(struct thrent *thrptr)
+{
+    message msg;
+
+    if (0 == thrptr->msgqmax)
+    {
+        thrptr->hasmsg = FALSE;
+        return thrptr->msg;
+    }
+
+    msg = thrptr->msgq[thrptr->msgqhead];
+    thrptr->msgqhead = (thrptr->msgqhead + 1) % thrptr->msgqmax;
+    if (0 == --thrptr->msgqcount)
+    {
+        thrptr->hasmsg = FALSE;
+    }
+    signal(thrptr->msgqroom);
+    return msg;
+}
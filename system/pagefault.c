@@ -0,0 +1,143 @@
+/**
+ * @file pagefault.c
+ * Demand paging: backing reserved user memory when it is first touched
+ */
+
+#include <interrupt.h>
+#include <memory.h>
+#include <paging.h>
+#include <framealloc.h>
+#include <segment.h>
+#include <stdio.h>
+#include <thread.h>
+#include <trace.h>
+
+extern void xtrap(int, int *);
+
+/**
+ * Determines whether `addr` lies in the guard page below the thread's stack region, which is
+ * never backed so that a thread running off the bottom of its stack faults rather than
+ * writing over its heap.
+ */
+static bool stackguard(struct thrent *thrptr, uint addr) {
+  uint stackbottom = USERSPACE_END - thrptr->stklen;
+
+  return addr < stackbottom && addr >= stackbottom - STKGUARD;
+}
+
+/**
+ * Determines whether `addr` is memory the thread has reserved.  That is the heap, from
+ * USERSPACE_BASE up to the thread's break, and the stack region, except for the bodies of
+ * blocks sitting free in the thread's memlist.  The header of a free block counts as
+ * reserved since memget() and memfree() write it.  Nothing between the break and the
+ * stack, the guard page included, is reserved.
+ */
+static bool pagereserved(struct thrent *thrptr, uint addr) {
+  struct memblock *block;
+
+  if(addr < USERSPACE_BASE || addr >= USERSPACE_END
+     || (addr >= thrptr->brk && addr < USERSPACE_END - thrptr->stklen)) {
+    return FALSE;
+  }
+
+  for(block = thrptr->memlist.next; block != NULL; block = block->next) {
+    if((uint)block + sizeof(struct memblock) <= addr && addr < (uint)block + block->length) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+ * Determines whether the whole 4MB region containing `addr` can be backed by one large page:
+ * it must lie in the heap, below the thread's break, and hold no part of the body of
+ * a free block.  Only memory-heavy threads which reserved that much at once qualify.
+ */
+static bool largereserved(struct thrent *thrptr, uint addr) {
+  struct memblock *block;
+  uint base = addr & ~(LARGE_PAGE_SIZE - 1);
+  uint end = base + LARGE_PAGE_SIZE;
+
+  if(base < USERSPACE_BASE || end > thrptr->brk) {
+    return FALSE;
+  }
+
+  for(block = thrptr->memlist.next; block != NULL && (uint)block < end; block = block->next) {
+    if((uint)block + sizeof(struct memblock) < end && base < (uint)block + block->length) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+ * Page fault handler, run by the page fault task with the CPU's error code
+ * A fault on a non-present page that the current thread has reserved is resolved by
+ * backing the page with a zeroed frame, or its whole 4MB with a large page when all of that
+ * is reserved and has no page table yet, and a write to a copy-on-write page by giving
+ * the thread its own copy, after which the faulting instruction restarts. Stacks grow this
+ * way, page by page, down to the guard page below them.
+ * Anything else, stack overflow included, is reported through xtrap(), which halts.
+ * @return OK once the fault has been resolved
+ */
+syscall pagefault(uint errcode) {
+  uint faultaddr = readCR2();
+  struct thrent *thrptr = &thrtab[thrcurrent];
+
+  if(!(errcode & PF_PRESENT) && largepages && largereserved(thrptr, faultaddr)
+     && pageinlarge(faultaddr) == OK) {
+    PAGING_TRACE("Paged in large page at 0x%08X", faultaddr);
+    thrptr->pgfaults++;
+    thrptr->rss += LARGE_FRAMES;
+    return OK;
+  }
+
+  if(!(errcode & PF_PRESENT) && pagereserved(thrptr, faultaddr) && pagein(faultaddr) == OK) {
+    PAGING_TRACE("Paged in 0x%08X", faultaddr);
+    thrptr->pgfaults++;
+    thrptr->rss++;
+    // The stack grows down from USERSPACE_END, so its depth is measured from there
+    if(faultaddr >= USERSPACE_END - thrptr->stklen) {
+      uint depth = (USERSPACE_END - truncframe(faultaddr)) / FRAME_SIZE;
+      if(depth > thrptr->stkpeak) {
+	thrptr->stkpeak = depth;
+      }
+    }
+    return OK;
+  }
+
+  if((errcode & PF_PRESENT) && (errcode & PF_WRITE) && pageunshare(faultaddr) == OK) {
+    PAGING_TRACE("Unshared copy-on-write page 0x%08X", faultaddr);
+    thrptr->pgfaults++;
+    return OK;
+  }
+
+  if(stackguard(thrptr, faultaddr)) {
+    kprintf("Stack overflow in thread %d (%s) at 0x%08X\r\n", thrcurrent, thrptr->name, faultaddr);
+  } else {
+    kprintf("Unresolvable page fault at 0x%08X\r\n", faultaddr);
+  }
+
+  // Lay the faulting task's registers out the way xtrap() expects a trap frame
+  int trapframe[15];
+  trapframe[0] = errcode;
+  trapframe[1] = kerneltss.esp;
+  trapframe[2] = kerneltss.edi;
+  trapframe[3] = kerneltss.esi;
+  trapframe[4] = kerneltss.ebp;
+  trapframe[5] = kerneltss.esp;
+  trapframe[6] = kerneltss.ebx;
+  trapframe[7] = kerneltss.edx;
+  trapframe[8] = kerneltss.ecx;
+  trapframe[9] = kerneltss.eax;
+  trapframe[10] = kerneltss.ebp;
+  trapframe[11] = errcode;
+  trapframe[12] = kerneltss.eip;
+  trapframe[13] = kerneltss.cs;
+  trapframe[14] = kerneltss.eflags;
+  xtrap(PAGEFAULT, trapframe + 2);
+
+  return SYSERR;
+}
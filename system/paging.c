@@ -3,12 +3,20 @@
  * Functions for performing paging operations
  */
 
+#include <interrupt.h>
 #include <paging.h>
 #include <framealloc.h>
+#include <segment.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread.h>
 
 // Definitions of declared global vars
 uint *kernelidentitytable;
+uint kernelpde;
+uint *kmaptable;
+bool largepages;
 
 /**
  * Initializes the page table given a logical base address of the table
@@ -24,60 +32,90 @@ void initpagetable(uint *tablebaseaddr) {
 
 /**
  * Reclaim all the frames allocated to a certain thread
- * `pagedir` is the page directory of the thread to reclaim from
- */
-void reclaimframes(uint *pagedir) {
-  // Sadly, we have to do the same thing we did for create, and perform some readdressing
-
-  // First, we must initialize the page table in the current thread if it hasn't been allocated
-  uint *pagedirentry = (uint*)0xFFFFF004; //pagedirentry of the currently running thread
-  bool hadtomakepagetable = FALSE;
-  if(get_bit(*pagedirentry, 0) == 0) {
-    hadtomakepagetable = TRUE;
-    *pagedirentry = framealloc() | 3;
-  }
-
-  // Now we can use the page table
-  uint *currpagetablemodifier = (uint*)0xFFC01000;
-  // Save the current pte values so we can restore them later
-  uint savedptes[2];
-  savedptes[0] = *currpagetablemodifier;
-  savedptes[1] = *(currpagetablemodifier + 1);
-  
-  // Describe the 4 values to be used to create the old thread
-  uint *oldpagedir = (uint*)0x00400000;
-  uint *oldpagedirmodifier = currpagetablemodifier;
-  uint *oldpagetable = (uint*)0x00401000;
-  uint *oldpagetablemodifier = currpagetablemodifier + 1;
-
-  // Now load the page directory and start reclaiming memory
-  *oldpagedirmodifier = (uint)pagedir | 3;
-
-  int i,j;
-  for(i = 0; i < 1023; i++) {
-    if(get_bit(*(oldpagedir + i), 0) == 0) { // If the page table is present
-      *oldpagetablemodifier = *(oldpagedir + i) | 3;
-      for(j = 0; j < 1024; j++) {
-	if(get_bit(*(oldpagetable + j), 0) == 1) { // If frame is present
-	  freeframe((*(oldpagetable + j)) & 0xFFFFFFF0); // Clear rightmost 4 bits
-	}
+ * `pagedir` is the page directory of the thread to reclaim from and `ptmap` the summary of
+ * the page tables present in it; only the tables marked there are visited
+ */
+void reclaimframes(uint *pagedir, uint *ptmap) {
+  // The old thread's directory is reached through a temporary mapping
+  uint *oldpagedir = kmap((uint)pagedir);
+
+  uint i,w,bits;
+  for(w = 0; w < PTMAP_WORDS; w++) {
+    // Words with no tables are skipped whole
+    for(i = w * 32, bits = *(ptmap + w); bits != 0; i++, bits >>= 1) {
+      if(bits & 1) {
+	reclaimtable(oldpagedir, i);
       }
-      // Reclaim the page table itself last
-      freeframe((*(oldpagedir + i)) & 0xFFFFFFF0); // Clear rightmost 4 bits
     }
   }
-  
+  kunmap(oldpagedir);
+
   // Reclaim the page directory of the dying thread
-  freeframe(((uint)pagedir) & 0xFFFFFFF0);
+  freeframe(((uint)pagedir) & ~(FRAME_SIZE - 1));
+}
+
+/**
+ * Reclaim the frames mapped by one entry of a dead thread's page directory, and its page table
+ * `oldpagedir` is a mapping of the directory and `i` the entry.  Entries below user space and
+ * the recursive entry are left alone.  The reaper frees a directory an entry at a time so
+ * interrupts are not held off for the whole address space.
+ */
+void reclaimtable(uint *oldpagedir, uint i) {
+  uint j;
 
-  // Restore the original value of the currently running thread's pte
-  *currpagetablemodifier = savedptes[0];
-  *(currpagetablemodifier + 1) = savedptes[1];
-  if(hadtomakepagetable) {
-    freeframe((*pagedirentry) & 0xFFFFFFF0); // Clear the rightmost flag bits
-    *pagedirentry = 0x00000000;
+  // Entries below user space are shared by every directory and entry 1023 maps the directory itself
+  if(i < (USERSPACE_BASE >> 22) || i == 1023) {
+    return;
+  }
+  if((*(oldpagedir + i) & (PAGE_LARGE | PAGE_PRESENT)) == (PAGE_LARGE | PAGE_PRESENT)) {
+    // A large page has no table, just its frames
+    freeframe_n(*(oldpagedir + i) & ~(LARGE_PAGE_SIZE - 1), LARGE_FRAMES);
+  } else if(get_bit(*(oldpagedir + i), 0) == 1) { // If the page table is present
+    // Each of its page tables is reached through a temporary mapping too
+    uint *oldpagetable = kmap(*(oldpagedir + i) & ~(FRAME_SIZE - 1));
+    for(j = 0; j < 1024; j++) {
+      if(get_bit(*(oldpagetable + j), 0) == 1) { // If frame is present
+	freeframe((*(oldpagetable + j)) & ~(FRAME_SIZE - 1)); // Clear the flag bits
+      }
+    }
+    kunmap(oldpagetable);
+    // Reclaim the page table itself last
+    freeframe((*(oldpagedir + i)) & ~(FRAME_SIZE - 1)); // Clear the flag bits
   }
-  
+}
+
+/**
+ * Backs the run of non-present pages starting at `pagetableindex` in `pagetable` with frames
+ * The run stops at the end of the page table, at `pageend`, or at the first page already present.
+ * A single contiguous allocation is tried first, falling back to one frame per page, and
+ * the run is cut short if even that fails.
+ * `pageaddr` is the virtual address of the page at `pagetableindex`
+ * @return The number of pages which were backed, 0 if no frame was free
+ */
+static uint backrun(uint *pagetable, uint pagetableindex, uint pageaddr, uint pageend) {
+  uint run = 1;
+  while(pagetableindex + run < 1024 && pageaddr + run * FRAME_SIZE < pageend
+	&& get_bit(*(pagetable + pagetableindex + run), 0) == 0) {
+    run++;
+  }
+
+  uint frameaddr = framealloc_n(run);
+  uint j;
+  for(j = 0; j < run; j++) {
+    if(frameaddr == SYSERR) {
+      // No contiguous run was available, so allocate frames individually
+      uint frame = framealloc();
+      if(frame == SYSERR) {
+	// Out of frames, the rest of the run stays not present
+	return j;
+      }
+      *(pagetable + pagetableindex + j) = frame | 3;
+    } else {
+      *(pagetable + pagetableindex + j) = (frameaddr + j * FRAME_SIZE) | 3;
+    }
+  }
+
+  return run;
 }
 
 /**
@@ -86,13 +124,16 @@ void reclaimframes(uint *pagedir) {
  * will point the page table entries to the allocated frames and the page directory
  * entries to the created page tables
  * If a page for a section of the defined region has already been paged, new frames will not be allocated
+ * Paging stops at the first frame or page table which can't be allocated, leaving the rest not present
+ * @return The number of pages which were backed, not counting page tables
  */
-void pageregion(uint regionstart, uint regionend) {
+uint pageregion(uint regionstart, uint regionend) {
   uint pagestart = truncframe(regionstart);
   uint pageend = roundframe(regionend);
 
   // The virtual address to access the entries of the current page directory with
   uint *pagedir = (uint*)0xFFFFF000;
+  uint backed = 0;
 
   uint i;
   for(i = pagestart; i < pageend; i += 0x1000) {
@@ -101,17 +142,23 @@ void pageregion(uint regionstart, uint regionend) {
 
     uint *pagetable;
 
+    // A large page already backs all of its 4MB
+    if((*(pagedir + pagedirindex) & (PAGE_LARGE | PAGE_PRESENT)) == (PAGE_LARGE | PAGE_PRESENT)) {
+      i = ((pagedirindex + 1) << 22) - 0x1000;
+      continue;
+    }
+
     // If the page table's entry in the pde is not present, create a new page table
     if(get_bit(*(pagedir + pagedirindex), 0) == 0) {
-      uint pagetableaddr = framealloc();
+      // A zeroed frame is a table of entries which are all not present
+      uint pagetableaddr = framealloc_zeroed();
+      if(pagetableaddr == SYSERR) {
+	break;
+      }
 
       // Set page table to R/W and present
       *(pagedir + pagedirindex) = pagetableaddr | 3;
-
-      // Determine the virtual address to modify the entries of the page table
-      pagetable = (uint*)(0xFFC00000 + 0x1000 * pagedirindex);
-
-      initpagetable(pagetable);
+      ptmapset(thrtab[thrcurrent].ptmap, pagedirindex);
     }
 
     // Determine the virtual address to modify the entries of the page table
@@ -122,71 +169,495 @@ void pageregion(uint regionstart, uint regionend) {
 
     // Allocate a frame for that page if there isn't one already
     if(get_bit(*(pagetable + pagetableindex), 0) == 0) {
-      // Allocate a frame and point the page table entry to it
-      *(pagetable + pagetableindex) = framealloc() | 3;
+      uint run = backrun(pagetable, pagetableindex, i, pageend);
+      // A short run is retried from the page after it, which then backs nothing
+      if(run == 0) {
+	break;
+      }
+      i += (run - 1) * FRAME_SIZE;
+      backed += run;
     }
   }
+
+  return backed;
 }
 
 /**
  * A modification of pageregion, this performs the same functionality but rather than using the page 
- * directory and tables of the currently running thread, it operates on the given page directory address.
- * Additionally, `ptemodifier` is required to be a pointer to a pte of the current thread which we can freely modify
- * and point to new pages. `virtualpagetableaddr` must be the virtual address of the page which `ptemodifier` corresponds to.
- *
- * I know this is very convoluted and awkward, but separating this code out into this method makes it much easier to set up
- * structures in memory for a new thread during a create()
+ * directory and tables of the currently running thread, it operates on the given page directory.
+ * `pagedir` must be a kernel mapping of the directory, as returned by kmap(). Each page table is
+ * edited through a temporary mapping of its own, so the current thread's mappings are never touched.
+ * Page tables created are marked in `ptmap`, the directory's summary. As with pageregion, paging
+ * stops at the first frame or page table which can't be allocated.
+ * @return The number of pages which were backed, not counting page tables
  */
-void pageregionwith(uint regionstart, uint regionend, uint *pagedir, uint *ptemodifier, uint *virtualpagetableaddr) {
-  kprintf("entering pageregionwith\n");
+uint pageregionwith(uint regionstart, uint regionend, uint *pagedir, uint *ptmap) {
   uint pagestart = truncframe(regionstart);
   uint pageend = roundframe(regionend);
+  uint backed = 0;
+
+  // Temporary mapping of the page table currently being filled in
+  uint *pagetable = NULL;
+  uint mappedindex = 0;
 
   uint i;
   for(i = pagestart; i < pageend; i += 0x1000) {
     // Extract the page directory index
     uint pagedirindex = i >> 22;
 
-    // If the page table's entry in the pde is not present, create a new page table
-    if(get_bit(*(pagedir + pagedirindex), 0) == 0) {
-      uint pagetableaddr = framealloc();
-      kprintf("creating pagetable for pagedir index %d with frameaddr 0x%8.8X\n", pagedirindex, pagetableaddr);
+    if(pagetable == NULL || pagedirindex != mappedindex) {
+      if(pagetable != NULL) {
+	kunmap(pagetable);
+      }
 
-      // Set page table to R/W and present
-      *(pagedir + pagedirindex) = pagetableaddr | 3;
+      // If the page table's entry in the pde is not present, create a new page table
+      if(get_bit(*(pagedir + pagedirindex), 0) == 0) {
+	// A zeroed frame is a table of entries which are all not present
+	uint pagetableaddr = framealloc_zeroed();
+	pagetable = NULL;
+	if(pagetableaddr == SYSERR) {
+	  break;
+	}
 
-      // Set ptemodifier to point to pagetableaddr so we can use virtualpagetableaddr to modify the page table
-      *ptemodifier = pagetableaddr | 3;
-      
-      initpagetable(virtualpagetableaddr);
-    } else {
-      // Set ptemodifier to point to the page table's address so we can use virtualpagetableaddr to modify the page table
-      *ptemodifier = (*(pagedir + pagedirindex)) | 3;
+	// Set page table to R/W and present
+	*(pagedir + pagedirindex) = pagetableaddr | 3;
+	ptmapset(ptmap, pagedirindex);
+	pagetable = kmap(pagetableaddr);
+      } else {
+	pagetable = kmap(*(pagedir + pagedirindex) & ~(FRAME_SIZE - 1));
+      }
+      if(pagetable == NULL) {
+	break;
+      }
+      mappedindex = pagedirindex;
     }
 
     // Extract the page table index
     uint pagetableindex = (i << 10) >> 22;
 
     // Allocate a frame for that page if there isn't one already
-    if(get_bit(*(virtualpagetableaddr + pagetableindex), 0) == 0) {
-      kprintf("allocating page with index %d\n", pagetableindex);
-      // Allocate a frame and point the page table entry to it
-      *(virtualpagetableaddr + pagetableindex) = framealloc() | 3;
+    if(get_bit(*(pagetable + pagetableindex), 0) == 0) {
+      uint run = backrun(pagetable, pagetableindex, i, pageend);
+      if(run == 0) {
+	break;
+      }
+      i += (run - 1) * FRAME_SIZE;
+      backed += run;
+    }
+  }
+
+  if(pagetable != NULL) {
+    kunmap(pagetable);
+  }
+
+  return backed;
+}
+
+/**
+ * Unmaps every page lying wholly inside [regionstart, regionend) in the current page directory
+ * and returns its frame to the frame allocator, leaving the entry not present so a later touch
+ * faults. Each released page is flushed from the TLB with invlpg, and a page table whose whole
+ * 4MB falls inside the region is freed as well. A page table that isn't present is skipped in
+ * one step, so releasing a large sparse region stays cheap. A large page is released whole if
+ * the region covers it, and otherwise split so the covered part can go.
+ * @return The number of pages which were released, not counting page tables
+ */
+uint pagerelease(uint regionstart, uint regionend) {
+  // The virtual address to access the entries of the current page directory with
+  uint *pagedir = (uint*)0xFFFFF000;
+
+  // Never reach into the shared entries below user space or the recursive mapping above it
+  if(regionstart < USERSPACE_BASE) {
+    regionstart = USERSPACE_BASE;
+  }
+  if(regionend > USERSPACE_END) {
+    regionend = USERSPACE_END;
+  }
+  uint pagestart = truncframe(regionstart + FRAME_SIZE - 1);
+  uint pageend = truncframe(regionend);
+  uint released = 0;
+
+  uint i = pagestart;
+  while(i < pageend) {
+    uint pagedirindex = i >> 22;
+    uint tablestart = pagedirindex << 22;
+    uint tableend = (pagedirindex + 1) << 22;
+    uint *pagetable = (uint*)(0xFFC00000 + 0x1000 * pagedirindex);
+
+    if(get_bit(*(pagedir + pagedirindex), 0) == 0) {
+      i = tableend;
+      continue;
+    }
+
+    if(*(pagedir + pagedirindex) & PAGE_LARGE) {
+      if(tablestart >= pagestart && tableend <= pageend) {
+	uint frameaddr = *(pagedir + pagedirindex) & ~(LARGE_PAGE_SIZE - 1);
+	*(pagedir + pagedirindex) = PAGE_RW;
+	ptmapclear(thrtab[thrcurrent].ptmap, pagedirindex);
+	invlpg(tablestart);
+	invlpg((uint)pagetable);
+	freeframe_n(frameaddr, LARGE_FRAMES);
+	released += LARGE_FRAMES;
+	i = tableend;
+	continue;
+      }
+      if(pagesplit(tablestart) == SYSERR) {
+	// Without a table to split into, the large page stays whole
+	i = tableend;
+	continue;
+      }
+    }
+
+    uint stop = (pageend < tableend) ? pageend : tableend;
+    for(; i < stop; i += FRAME_SIZE) {
+      uint *pte = pagetable + ((i << 10) >> 22);
+      if(get_bit(*pte, 0) == 1) {
+	uint frameaddr = *pte & ~(FRAME_SIZE - 1);
+	*pte = PAGE_RW;
+	invlpg(i);
+	// Only drops this directory's reference if the frame is shared copy-on-write or
+	// belongs to a shared memory segment
+	freeframe(frameaddr);
+	released++;
+      }
+    }
+
+    if(tablestart >= pagestart && tableend <= pageend) {
+      uint pagetableaddr = *(pagedir + pagedirindex) & ~(FRAME_SIZE - 1);
+      *(pagedir + pagedirindex) = PAGE_RW;
+      ptmapclear(thrtab[thrcurrent].ptmap, pagedirindex);
+      invlpg((uint)pagetable);
+      freeframe(pagetableaddr);
+    }
+  }
+
+  return released;
+}
+
+/**
+ * Maps the frame at `frameaddr` into a free temporary kernel slot
+ * The slots sit in kmaptable, which every page directory shares, so the mapping
+ * is visible whichever thread is running. Callers must release the slot with kunmap().
+ * @return The virtual address of the mapped frame, or NULL if every slot is in use
+ */
+void *kmap(uint frameaddr) {
+  // The slots' page table is reached through the recursive mapping like any other
+  uint *slotptes = (uint*)0xFFC00000 + (KMAP_BASE >> 12);
+  irqmask im = disable();
+
+  uint slot;
+  for(slot = 0; slot < KMAP_SLOTS; slot++) {
+    if(get_bit(*(slotptes + slot), 0) == 0) {
+      break;
+    }
+  }
+  if(slot == KMAP_SLOTS) {
+    restore(im);
+    return NULL;
+  }
+
+  uint addr = KMAP_BASE + slot * FRAME_SIZE;
+  *(slotptes + slot) = (frameaddr & ~(FRAME_SIZE - 1)) | PAGE_RW | PAGE_PRESENT;
+  invlpg(addr);
+  restore(im);
+
+  return (void*)addr;
+}
+
+/**
+ * Releases the temporary kernel slot holding `addr`, which was returned by kmap()
+ *
+ */
+void kunmap(void *addr) {
+  uint slot = ((uint)addr - KMAP_BASE) >> 12;
+  if((uint)addr < KMAP_BASE || slot >= KMAP_SLOTS) {
+    return;
+  }
+
+  // Leave the slot not present so stray uses of a released mapping fault
+  *((uint*)0xFFC00000 + (KMAP_BASE >> 12) + slot) = PAGE_RW;
+  invlpg(KMAP_BASE + slot * FRAME_SIZE);
+}
+
+/**
+ * Backs the page containing `addr` in the current page directory with a zeroed frame,
+ * creating the page table first if need be. Both come from framealloc_zeroed(), so the
+ * zeroing has usually been done ahead of time by the null thread
+ * @return OK on success, SYSERR if no frame could be allocated
+ */
+syscall pagein(uint addr) {
+  // The virtual address to access the entries of the current page directory with
+  uint *pagedir = (uint*)0xFFFFF000;
+
+  uint pagedirindex = addr >> 22;
+  uint pagetableindex = (addr << 10) >> 22;
+  uint *pagetable = (uint*)(0xFFC00000 + 0x1000 * pagedirindex);
+
+  if(get_bit(*(pagedir + pagedirindex), 0) == 0) {
+    uint pagetableaddr = framealloc_zeroed();
+    if(pagetableaddr == SYSERR) {
+      return SYSERR;
+    }
+    *(pagedir + pagedirindex) = pagetableaddr | PAGE_RW | PAGE_PRESENT;
+    ptmapset(thrtab[thrcurrent].ptmap, pagedirindex);
+  }
+
+  uint frameaddr = framealloc_zeroed();
+  if(frameaddr == SYSERR) {
+    return SYSERR;
+  }
+  *(pagetable + pagetableindex) = frameaddr | PAGE_RW | PAGE_PRESENT;
+
+  return OK;
+}
+
+/**
+ * Backs the whole 4MB region containing `addr` in the current page directory with a zeroed
+ * large page. The region must not have a page table yet
+ * @return OK on success, SYSERR if large pages are disabled or no zeroed large page is ready,
+ * in which case the fault is served with a 4KB page
+ */
+syscall pageinlarge(uint addr) {
+  // The virtual address to access the entries of the current page directory with
+  uint *pagedir = (uint*)0xFFFFF000;
+
+  uint pagedirindex = addr >> 22;
+
+  if(!largepages || get_bit(*(pagedir + pagedirindex), 0) == 1) {
+    return SYSERR;
+  }
+
+  // Clearing 4MB here would hold interrupts off for too long, so only a large page the null
+  // thread has already zeroed is used
+  uint frameaddr = framealloc_largezeroed();
+  if(frameaddr == SYSERR) {
+    return SYSERR;
+  }
+  *(pagedir + pagedirindex) = frameaddr | PAGE_LARGE | PAGE_RW | PAGE_PRESENT;
+  ptmapset(thrtab[thrcurrent].ptmap, pagedirindex);
+  // The recursive mapping may have cached the entry as not present
+  invlpg(0xFFC00000 + 0x1000 * pagedirindex);
+
+  return OK;
+}
+
+/**
+ * Replaces the large page containing `addr` in the current page directory with a page table
+ * mapping the same frames, so parts of it can be unmapped or shared on their own.
+ * Succeeds without change if the region isn't a large page
+ * @return OK on success, SYSERR if no frame is available for the page table
+ */
+syscall pagesplit(uint addr) {
+  // The virtual address to access the entries of the current page directory with
+  uint *pagedir = (uint*)0xFFFFF000;
+
+  uint pagedirindex = addr >> 22;
+  uint pde = *(pagedir + pagedirindex);
+
+  if((pde & (PAGE_LARGE | PAGE_PRESENT)) != (PAGE_LARGE | PAGE_PRESENT)) {
+    return OK;
+  }
+
+  uint pagetableaddr = framealloc();
+  if(pagetableaddr == SYSERR) {
+    return SYSERR;
+  }
+  // Fill the table through a temporary mapping, since the recursive mapping of this entry
+  // still reaches the large page itself
+  uint *pagetable = kmap(pagetableaddr);
+  if(pagetable == NULL) {
+    freeframe(pagetableaddr);
+    return SYSERR;
+  }
+  uint frameaddr = pde & ~(LARGE_PAGE_SIZE - 1);
+  uint j;
+  for(j = 0; j < 1024; j++) {
+    *(pagetable + j) = (frameaddr + j * FRAME_SIZE) | PAGE_RW | PAGE_PRESENT;
+  }
+  kunmap(pagetable);
+
+  *(pagedir + pagedirindex) = pagetableaddr | PAGE_RW | PAGE_PRESENT;
+  invlpg(pagedirindex << 22);
+  invlpg(0xFFC00000 + 0x1000 * pagedirindex);
+
+  return OK;
+}
+
+/**
+ * Maps the frame at `frameaddr` at the page containing `addr` in the current page directory,
+ * with `flags` set in the entry besides PAGE_RW and PAGE_PRESENT. The mapping holds a reference
+ * on the frame, which pagerelease() or reclaimframes() drops again. A page table is created if
+ * need be, and a large page is split first
+ * @return OK on success, SYSERR if the page is already present or no page table could be made
+ */
+syscall pagemap(uint addr, uint frameaddr, uint flags) {
+  // The virtual address to access the entries of the current page directory with
+  uint *pagedir = (uint*)0xFFFFF000;
+
+  uint pagedirindex = addr >> 22;
+  uint pagetableindex = (addr << 10) >> 22;
+  uint *pagetable = (uint*)(0xFFC00000 + 0x1000 * pagedirindex);
+
+  if(pagesplit(addr) == SYSERR) {
+    return SYSERR;
+  }
+  if(get_bit(*(pagedir + pagedirindex), 0) == 0) {
+    uint pagetableaddr = framealloc_zeroed();
+    if(pagetableaddr == SYSERR) {
+      return SYSERR;
+    }
+    *(pagedir + pagedirindex) = pagetableaddr | PAGE_RW | PAGE_PRESENT;
+    ptmapset(thrtab[thrcurrent].ptmap, pagedirindex);
+    invlpg((uint)pagetable);
+  }
+  if(get_bit(*(pagetable + pagetableindex), 0) == 1 || frameref(frameaddr) == SYSERR) {
+    return SYSERR;
+  }
+
+  *(pagetable + pagetableindex) = truncframe(frameaddr) | flags | PAGE_RW | PAGE_PRESENT;
+  invlpg(truncframe(addr));
+
+  return OK;
+}
+
+/**
+ * Translates `addr` through the page directory at physical address `pagedir`, which need not be
+ * the current one, by reading it and the page table through temporary mappings
+ * @return The physical address `addr` maps to, or SYSERR if it isn't present
+ */
+uint pagelookup(uint *pagedir, uint addr) {
+  uint *dir = kmap((uint)pagedir);
+  if(dir == NULL) {
+    return SYSERR;
+  }
+  uint pde = *(dir + (addr >> 22));
+  kunmap(dir);
+
+  if(get_bit(pde, 0) == 0) {
+    return SYSERR;
+  }
+  if(pde & PAGE_LARGE) {
+    return (pde & ~(LARGE_PAGE_SIZE - 1)) | (addr & (LARGE_PAGE_SIZE - 1));
+  }
+
+  uint *pagetable = kmap(pde & ~(FRAME_SIZE - 1));
+  if(pagetable == NULL) {
+    return SYSERR;
+  }
+  uint pte = *(pagetable + ((addr << 10) >> 22));
+  kunmap(pagetable);
+
+  if(get_bit(pte, 0) == 0) {
+    return SYSERR;
+  }
+  return (pte & ~(FRAME_SIZE - 1)) | (addr & (FRAME_SIZE - 1));
+}
+
+/**
+ * Counts the page tables and pages present in the user part of the page directory at physical
+ * address `pagedir`, reading it through temporary mappings
+ */
+void pagewalk(uint *pagedir, struct pagestat *stat) {
+  uint i, j;
+
+  stat->tables = 0;
+  stat->pages = 0;
+  stat->shared = 0;
+  stat->large = 0;
+
+  uint *dir = kmap((uint)pagedir);
+  if(dir == NULL) {
+    return;
+  }
+  for(i = USERSPACE_BASE >> 22; i < 1023; i++) {
+    uint pde = *(dir + i);
+    if(get_bit(pde, 0) == 0) {
+      continue;
     }
+    if(pde & PAGE_LARGE) {
+      stat->large++;
+      stat->pages += LARGE_FRAMES;
+      continue;
+    }
+
+    stat->tables++;
+    uint *pagetable = kmap(pde & ~(FRAME_SIZE - 1));
+    if(pagetable == NULL) {
+      continue;
+    }
+    for(j = 0; j < 1024; j++) {
+      if(get_bit(*(pagetable + j), 0) == 1) {
+	stat->pages++;
+	if(*(pagetable + j) & PAGE_COW) {
+	  stat->shared++;
+	}
+      }
+    }
+    kunmap(pagetable);
   }
+  kunmap(dir);
+}
 
-  kprintf("Done with pageregionwith\n");
-  //kprintf("\0");
-} 
+/**
+ * Gives the current page directory a private, writable copy of the copy-on-write page
+ * containing `addr`. A frame still shared with another directory is copied into a new
+ * frame; a frame whose other references have all been dropped is simply made writable.
+ * @return OK on success, SYSERR if the page isn't copy-on-write or no frame is available
+ */
+syscall pageunshare(uint addr) {
+  // The virtual address to access the entries of the current page directory with
+  uint *pagedir = (uint*)0xFFFFF000;
+
+  uint pagedirindex = addr >> 22;
+  uint pagetableindex = (addr << 10) >> 22;
+  uint *pagetable = (uint*)(0xFFC00000 + 0x1000 * pagedirindex);
+  uint pageaddr = truncframe(addr);
+
+  // Large pages are split before they are ever shared
+  if(get_bit(*(pagedir + pagedirindex), 0) == 0 || (*(pagedir + pagedirindex) & PAGE_LARGE)) {
+    return SYSERR;
+  }
+  uint *pte = pagetable + pagetableindex;
+  if(get_bit(*pte, 0) == 0 || !(*pte & PAGE_COW)) {
+    return SYSERR;
+  }
+
+  uint oldframeaddr = *pte & ~(FRAME_SIZE - 1);
+  if(framerefcount(oldframeaddr) > 1) {
+    uint frameaddr = framealloc();
+    if(frameaddr == SYSERR) {
+      return SYSERR;
+    }
+    // Fill the new frame through a temporary mapping before switching the pte over to it
+    void *copy = kmap(frameaddr);
+    if(copy == NULL) {
+      freeframe(frameaddr);
+      return SYSERR;
+    }
+    memcpy(copy, (void*)pageaddr, FRAME_SIZE);
+    kunmap(copy);
+    *pte = frameaddr | PAGE_RW | PAGE_PRESENT;
+    invlpg(pageaddr);
+    // Drop this directory's reference to the shared frame
+    freeframe(oldframeaddr);
+  } else {
+    *pte = (*pte & ~PAGE_COW) | PAGE_RW;
+    invlpg(pageaddr);
+  }
+
+  return OK;
+}
 
 /**
  * Enable paging in the CPU
+ * Write protection (CR0.WP) is enabled as well so that read-only pages fault even though
+ * the kernel runs at ring 0, which copy-on-write depends on
  *
  */
 void enablepaging() {
   __asm__(
 	  "mov %%cr0, %%eax\n\t"
-	  "or $0x80000000, %%eax\n\t"
+	  "or $0x80010000, %%eax\n\t"
 	  "mov %%eax, %%cr0\n\t"
 	  :
 	  :
@@ -194,15 +665,93 @@ void enablepaging() {
 	  );
 }
 
+/**
+ * Runs cpuid for `leaf` and returns the feature flags it leaves in edx
+ * cpuid overwrites eax, ebx and ecx as well, so eax is bound to an in/out operand and the
+ * other two are clobbered
+ */
+static uint cpuid_edx(uint leaf) {
+  uint edx;
+  __asm__ __volatile__(
+		       "cpuid\n\t"
+		       : "+a" (leaf), "=d" (edx)
+		       :
+		       : "%ebx", "%ecx"
+		       );
+  return edx;
+}
+
+/**
+ * Enable global pages (CR4.PGE) if the CPU supports them
+ * TLB entries for pages marked PAGE_GLOBAL then survive CR3 reloads, which keeps the kernel
+ * identity mapping cached across context switches
+ * @return TRUE if global pages were enabled
+ */
+bool enableglobalpages() {
+  uint features = cpuid_edx(1);
+  // CPUID.1:EDX bit 13 reports PGE support
+  if(get_bit(features, 13) == 0) {
+    return FALSE;
+  }
+
+  __asm__ __volatile__(
+		       "mov %%cr4, %%eax\n\t"
+		       "or $0x00000080, %%eax\n\t"
+		       "mov %%eax, %%cr4\n\t"
+		       :
+		       :
+		       : "%eax", "memory"
+		       );
+  return TRUE;
+}
+
+/**
+ * Enable 4MB pages (CR4.PSE) if the CPU supports them
+ * Page directory entries with PAGE_LARGE set then map a large page directly
+ * @return TRUE if large pages were enabled
+ */
+bool enablelargepages() {
+  uint features = cpuid_edx(1);
+  // CPUID.1:EDX bit 3 reports PSE support
+  if(get_bit(features, 3) == 0) {
+    return FALSE;
+  }
+
+  __asm__ __volatile__(
+		       "mov %%cr4, %%eax\n\t"
+		       "or $0x00000010, %%eax\n\t"
+		       "mov %%eax, %%cr4\n\t"
+		       :
+		       :
+		       : "%eax", "memory"
+		       );
+  return TRUE;
+}
+
+/**
+ * Disable global pages, which also flushes every global TLB entry
+ *
+ */
+void disableglobalpages() {
+  __asm__ __volatile__(
+		       "mov %%cr4, %%eax\n\t"
+		       "and $0xFFFFFF7F, %%eax\n\t"
+		       "mov %%eax, %%cr4\n\t"
+		       :
+		       :
+		       : "%eax", "memory"
+		       );
+}
+
 /**
  * Load the given page directory into CR3
  *
  */
 void loadCR3(uint *pagedir) {
-  if((uint)pagedir == 0x43d000) {
-    asm("nop");
-  }
-  
+  // Tasks entered through a task gate reload CR3 from their TSS, so keep both in step
+  kerneltss.cr3 = (ulong)pagedir;
+  pagefaulttss.cr3 = (ulong)pagedir;
+
   __asm__(
 	  "mov %0, %%eax\n\t"
 	  "mov %%eax, %%cr3\n\t"
@@ -211,3 +760,29 @@ void loadCR3(uint *pagedir) {
 	  : "%eax"
 	  );
 }
+
+/**
+ * Read the faulting linear address of the last page fault from CR2
+ *
+ */
+uint readCR2() {
+  uint cr2;
+  __asm__ __volatile__(
+		       "mov %%cr2, %0\n\t"
+		       : "=r" (cr2)
+		       );
+  return cr2;
+}
+
+/**
+ * Flush the TLB entry for the page containing `addr`
+ *
+ */
+void invlpg(uint addr) {
+  __asm__ __volatile__(
+		       "invlpg (%0)\n\t"
+		       :
+		       : "r" (addr)
+		       : "memory"
+		       );
+}
@@ -67,6 +67,25 @@ void set_evec(int exc_num, int handler)
     }
 }
 
+/**
+ * Set exception vector to switch to a hardware task
+ * @param exc_num exception number
+ * @param selector GDT selector of the task's TSS
+ */
+void set_taskgate(int exc_num, int selector)
+{
+    struct idt *pidt;
+
+    pidt = &idt[exc_num];
+    pidt->igd_loffset = 0;
+    pidt->igd_hoffset = 0;
+    pidt->igd_segsel = selector;
+    pidt->igd_mbz = 0;
+    pidt->igd_type = IGDT_TASK;
+    pidt->igd_dpl = 0;
+    pidt->igd_present = 1;
+}
+
 void set_handler(int exc_num, interrupt (*handler)(void))
 {
     exctab[exc_num] = handler;
@@ -22,6 +22,9 @@
 #define IRQ6     6 /* floppy disk controller              */
 #define IRQ7     7 /* parallel port / spurious interrupts */
 
+#define DEVNOTAVAIL  7 /* coprocessor not available exception */
+#define PAGEFAULT   14 /* page fault exception                */
+
 #define	IGDT_TASK	 5	/* task gate IDT descriptor       */
 #define	IGDT_INTR	14	/* interrupt gate IDT descriptor  */
 #define	IGDT_TRAPG	15	/* Trap Gate                      */
@@ -45,6 +48,7 @@ irqmask disable_irq(irqmask);
 /* Interrupt configuration function prototypes */
 void init_evec(void);
 void set_evec(int, int);
+void set_taskgate(int, int);
 void set_handler(int, interrupt (*)(void));
 void dispatch(int, int *);
 
@@ -12,8 +12,11 @@
 #include <string.h>
 #include <asm-i386/icu.h>
 #include <interrupt.h>
+#include <segment.h>
+#include <paging.h>
 
 extern ulong cpuid;             /* Processor id                    */
+extern ulong bootmemupper;      /* KB above 1 MB, from boot loader */
 
 extern struct platform platform;        /* Platform specific configuration */
 
@@ -36,7 +39,20 @@ int platforminit(void)
 
     /* Setup platform data                                 */
     strlcpy(platform.name, "Intel x86", PLT_STRMAX);
-    platform.maxaddr = (void *)0x1000000;
+    /* Memory ends where the boot loader says, or assume 16 MB.    */
+    /* Nothing from USERSPACE_END up can be a frame, so stop there */
+    if (bootmemupper >= (USERSPACE_END - 0x100000) / 1024)
+    {
+        platform.maxaddr = (void *)USERSPACE_END;
+    }
+    else if (0 != bootmemupper)
+    {
+        platform.maxaddr = (void *)(0x100000 + bootmemupper * 1024);
+    }
+    else
+    {
+        platform.maxaddr = (void *)0x1000000;
+    }
     platform.clkfreq = 1190000;
     platform.uart_dll = 1;
 
@@ -68,5 +84,8 @@ int platforminit(void)
     girmask = 0xfffb;
     lidt();
 
+    /* Hardware tasks for page fault handling              */
+    inittss();
+
     return OK; 
 }
@@ -1,9 +1,18 @@
 #include <segment.h>
 #include <memory.h>
+#include <interrupt.h>
+#include <stdlib.h>
 
 extern struct segdesc gdt[NSEGS];
 extern struct segdescreg gdtr;
 
+extern void pagefaultTask(void);
+extern void fpuTrap(void);
+
+struct tss kerneltss;           /* state of threads while a fault is handled */
+struct tss pagefaulttss;        /* task entered through the page fault gate  */
+static ulong faultstk[FAULTSTK / sizeof(ulong)];
+
 /**
  * This will insert a segment with the passed values into the descriptor
  * table entry.
@@ -57,3 +66,61 @@ void initialsegs(void)
     insertseg(3, 0x00000000, 0xffffffff, SEG_DATA_KERNEL);
 }
 
+
+/**
+ * Insert a byte-granular descriptor for a task state segment.
+ * @param index index of descriptor to write to
+ * @param tss   task state segment described
+ */
+static void inserttss(int index, struct tss *tss)
+{
+    struct segdesc *seg = &gdt[index];
+    ulong base = (ulong)tss;
+    ulong limit = sizeof(struct tss) - 1;
+
+    seg->lobase = base & 0xffff;
+    seg->midbase = (base >> 16) & 0xff;
+    seg->hibase = (base >> 24) & 0xff;
+    seg->lolimit = limit & 0xffff;
+    seg->hilimit = (limit >> 16) & 0xf;
+    seg->type = SEG_TYPE_TSS;
+    seg->dataseg = 0;
+    seg->dpl = 0;
+    seg->present = 1;
+    seg->avl = 0;
+    seg->mbz = 0;
+    seg->db = 0;
+    seg->gran = 0;
+}
+
+/**
+ * Set up the kernel and page fault tasks, load the task register, and
+ * route page faults through a task gate.  Every task switch sets CR0.TS,
+ * so device-not-available faults are answered by clearing it.
+ */
+void inittss(void)
+{
+    bzero(&kerneltss, sizeof(struct tss));
+    bzero(&pagefaulttss, sizeof(struct tss));
+
+    kerneltss.iomap = sizeof(struct tss);
+
+    pagefaulttss.eip = (ulong)pagefaultTask;
+    pagefaulttss.esp = (ulong)&faultstk[FAULTSTK / sizeof(ulong)];
+    pagefaulttss.eflags = 0x2;  /* interrupts off */
+    pagefaulttss.cs = 0x08;
+    pagefaulttss.ds = 0x10;
+    pagefaulttss.es = 0x10;
+    pagefaulttss.fs = 0x10;
+    pagefaulttss.ss = 0x10;
+    pagefaulttss.gs = 0x18;
+    pagefaulttss.iomap = sizeof(struct tss);
+
+    inserttss(KERNTSS_INDEX, &kerneltss);
+    inserttss(FAULTTSS_INDEX, &pagefaulttss);
+
+    __asm__ __volatile__("ltr %w0"::"r"(KERNTSS_SEL));
+
+    set_taskgate(PAGEFAULT, FAULTTSS_SEL);
+    set_evec(DEVNOTAVAIL, (long)fpuTrap);
+}
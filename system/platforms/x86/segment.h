@@ -50,6 +50,39 @@ struct segdescreg
 
 void insertseg(int, int, int, int);
 
+/* Task state segments */
+#define KERNTSS_INDEX  4                    /* GDT slot of the kernel task      */
+#define FAULTTSS_INDEX 5                    /* GDT slot of the page fault task  */
+#define KERNTSS_SEL    (KERNTSS_INDEX << 3)
+#define FAULTTSS_SEL   (FAULTTSS_INDEX << 3)
+#define SEG_TYPE_TSS   0x9                  /* available 32-bit TSS             */
+#define FAULTSTK       4096                 /* page fault task stack in bytes   */
+
+/**
+ * 32-bit hardware task state segment.  Xinu threads all run as a single
+ * hardware task; a second task with its own stack handles page faults so
+ * that faults on unbacked stack pages do not turn into double faults.
+ */
+struct tss
+{
+	ushort link, rsv0;
+	ulong  esp0;
+	ushort ss0, rsv1;
+	ulong  esp1;
+	ushort ss1, rsv2;
+	ulong  esp2;
+	ushort ss2, rsv3;
+	ulong  cr3, eip, eflags;
+	ulong  eax, ecx, edx, ebx, esp, ebp, esi, edi;
+	ushort es, rsv4, cs, rsv5, ss, rsv6, ds, rsv7, fs, rsv8, gs, rsv9;
+	ushort ldt, rsv10, trap, iomap;
+};
+
+extern struct tss kerneltss;
+extern struct tss pagefaulttss;
+
+void inittss(void);
+
 
 #define	SDT_INTG	14	/* Interrupt Gate	*/
 /*
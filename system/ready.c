@@ -27,7 +27,7 @@ int ready(tid_typ tid, bool resch)
     thrptr = &thrtab[tid];
     thrptr->state = THRREADY;
 
-    insert(tid, readylist, thrptr->prio);
+    readyinsert(tid, thrptr->prio);
 
     if (resch == RESCHED_YES)
     {
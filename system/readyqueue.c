@@ -0,0 +1,105 @@
+/**
+ * @file readyqueue.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <thread.h>
+#include <queue.h>
+
+ulong readymap[NPRIO / 32];     /**< levels which may hold threads    */
+
+/**
+ * @ingroup threads
+ *
+ * Allocate the per-level queues of the ready queue.
+ */
+void readyinit(void)
+{
+    int i;
+
+    readylist = queinit();
+    for (i = 1; i < NPRIO; i++)
+    {
+        queinit();
+    }
+    for (i = 0; i < NPRIO / 32; i++)
+    {
+        readymap[i] = 0;
+    }
+}
+
+/**
+ * @ingroup threads
+ *
+ * Append a thread to the ready queue level for its priority.  Threads of
+ * equal priority are kept in FIFO order.
+ * @param tid    thread ID to insert
+ * @param prio   thread priority
+ * @return OK
+ */
+int readyinsert(tid_typ tid, int prio)
+{
+    int level = prio2level(prio);
+
+    if (SYSERR == enqueue(tid, readyqueue(level)))
+    {
+        return SYSERR;
+    }
+    quetab[tid].key = prio;
+    readymap[level / 32] |= 1UL << (level % 32);
+    return OK;
+}
+
+/**
+ * @ingroup threads
+ *
+ * Find the highest priority level holding a ready thread.
+ * @return the level, or EMPTY if no thread is ready
+ */
+int readyfirst(void)
+{
+    int word, bit, level;
+
+    for (word = NPRIO / 32 - 1; word >= 0; word--)
+    {
+        while (readymap[word] != 0)
+        {
+            asm("bsrl %1, %0":"=r"(bit):"rm"(readymap[word]));
+            level = word * 32 + bit;
+            if (nonempty(readyqueue(level)))
+            {
+                return level;
+            }
+            /* emptied by getitem(), clear it now */
+            readymap[word] &= ~(1UL << bit);
+        }
+    }
+    return EMPTY;
+}
+
+/**
+ * @ingroup threads
+ *
+ * Remove the first thread at the highest ready priority level.
+ * @return thread ID of removed thread, or EMPTY if no thread is ready
+ */
+tid_typ readydequeue(void)
+{
+    int level;
+    tid_typ tid;
+
+    level = readyfirst();
+    if (EMPTY == level)
+    {
+        return EMPTY;
+    }
+
+    tid = dequeue(readyqueue(level));
+    if (isempty(readyqueue(level)))
+    {
+        readymap[level / 32] &= ~(1UL << (level % 32));
+    }
+    return tid;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file reaper.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <framealloc.h>
+#include <monitor.h>
+#include <paging.h>
+#include <string.h>
+#include <thread.h>
+#include <trace.h>
+#include <critical.h>
+
+/** Thread which tears down the address spaces of killed threads */
+tid_typ reapertid = BADTID;
+
+/* An address space waiting to be torn down */
+struct reapent
+{
+    uint *pagedir;              /* physical address of the directory    */
+    uint ptmap[PTMAP_WORDS];    /* page tables present in the directory */
+};
+
+static struct reapent reapq[NREAP];
+static int reaphead;            /* oldest entry                         */
+static int reapcount;           /* entries queued                       */
+
+/**
+ * @ingroup threads
+ *
+ * Free the frames of a dead thread's address space.  The work is queued
+ * for the reaper thread when it is running and has room, so kill() returns
+ * without walking the page tables; otherwise it is done at once.
+ * Interrupts must be disabled.
+ * @param pagedir  page directory of the dead thread
+ * @param ptmap    summary of the page tables present in pagedir
+ */
+void reap(uint *pagedir, uint *ptmap)
+{
+    struct reapent *entry;
+
+    if (isbadtid(reapertid) || reapcount >= NREAP)
+    {
+        reclaimframes(pagedir, ptmap);
+        return;
+    }
+
+    entry = &reapq[(reaphead + reapcount) % NREAP];
+    entry->pagedir = pagedir;
+    memcpy(entry->ptmap, ptmap, sizeof(entry->ptmap));
+    reapcount++;
+
+    /* Reap at the killer's priority, so busy threads cannot starve it */
+    if (thrtab[thrcurrent].prio > thrtab[reapertid].baseprio)
+    {
+        thrtab[reapertid].baseprio = thrtab[thrcurrent].prio;
+        moninherit(reapertid);
+    }
+
+    if (THRSUSP == thrtab[reapertid].state)
+    {
+        ready(reapertid, RESCHED_NO);
+    }
+}
+
+/**
+ * @ingroup threads
+ *
+ * Reaper thread.  Frees the address spaces queued by reap(), one at a time,
+ * and suspends itself when there are none left.  Interrupts are enabled
+ * between page tables, so a large address space does not hold them off.  While there is work
+ * queued it runs at the priority of the highest thread which queued any, so the frames come back
+ * even while that thread's peers stay busy, and it drops back to ::REAPPRIO when idle.
+ */
+thread reaper(void)
+{
+    struct reapent dead;
+    uint *window;
+    uint i, w, bits;
+    irqmask im;
+
+    reapertid = gettid();
+
+    while (TRUE)
+    {
+        im = CS_DISABLE();
+        if (0 == reapcount)
+        {
+            thrtab[reapertid].baseprio = REAPPRIO;
+            moninherit(reapertid);
+            suspend(reapertid);
+            CS_RESTORE(im);
+            continue;
+        }
+
+        dead = reapq[reaphead];
+        reaphead = (reaphead + 1) % NREAP;
+        reapcount--;
+        CS_RESTORE(im);
+
+        THREAD_TRACE("Reaping page directory 0x%08X", dead.pagedir);
+        for (w = 0; w < PTMAP_WORDS; w++)
+        {
+            for (i = w * 32, bits = dead.ptmap[w]; bits != 0;
+                 i++, bits >>= 1)
+            {
+                if (bits & 1)
+                {
+                    im = CS_DISABLE();
+                    window = kmap((uint)dead.pagedir);
+                    reclaimtable(window, i);
+                    kunmap(window);
+                    CS_RESTORE(im);
+                }
+            }
+        }
+        im = CS_DISABLE();
+        freeframe((uint)dead.pagedir & ~(FRAME_SIZE - 1));
+        CS_RESTORE(im);
+    }
+
+    return OK;
+}
@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <thread.h>
+#include <critical.h>
 
 /**
  * @ingroup threads
@@ -18,15 +19,14 @@ message receive(void)
     irqmask im;
     message msg;
 
-    im = disable();
+    im = CS_DISABLE();
     thrptr = &thrtab[thrcurrent];
     if (FALSE == thrptr->hasmsg)
     {                           /* if no message, wait for one */
         thrptr->state = THRRECV;
         resched();
     }
-    msg = thrptr->msg;          /* retrieve message                */
-    thrptr->hasmsg = FALSE;     /* reset message flag              */
-    restore(im);
+    msg = msgtake(thrptr);      /* retrieve oldest message         */
+    CS_RESTORE(im);
     return msg;
 }
@@ -9,7 +9,7 @@
 /**
  * @ingroup threads
  *
- * Clear messages, return waiting message (if any)
+ * Clear messages, return oldest waiting message (if any)
  * @return msg if available, NOMSG if no message
  */
 message recvclr(void)
@@ -22,13 +22,16 @@ message recvclr(void)
     thrptr = &thrtab[thrcurrent];
     if (thrptr->hasmsg)
     {
-        msg = thrptr->msg;
-    }                           /* retrieve message       */
+        msg = msgtake(thrptr);
+    }                           /* retrieve oldest message */
     else
     {
         msg = NOMSG;
     }
-    thrptr->hasmsg = FALSE;     /* reset message flag   */
+    while (thrptr->hasmsg)
+    {
+        msgtake(thrptr);        /* discard the rest of the ring */
+    }
     restore(im);
     return msg;
 }
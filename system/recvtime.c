@@ -8,6 +8,7 @@
 #include <stddef.h>
 #include <thread.h>
 #include <clock.h>
+#include <timer.h>
 
 /**
  * @ingroup threads
@@ -31,11 +32,7 @@ message recvtime(int maxwait)
     if (FALSE == thrptr->hasmsg)
     {
 #if RTCLOCK
-        if (SYSERR == insertd(thrcurrent, sleepq, maxwait))
-        {
-            restore(im);
-            return SYSERR;
-        }
+        tmset(&thrptr->timer, maxwait, wakeup, thrcurrent);
         thrtab[thrcurrent].state = THRTMOUT;
         resched();
 #else
@@ -46,8 +43,7 @@ message recvtime(int maxwait)
 
     if (thrptr->hasmsg)
     {
-        msg = thrptr->msg;      /* retrieve message              */
-        thrptr->hasmsg = FALSE; /* reset message flag            */
+        msg = msgtake(thrptr);  /* retrieve oldest message       */
     }
     else
     {
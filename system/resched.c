@@ -9,9 +9,12 @@
 #include <queue.h>
 #include <memory.h>
 #include <paging.h>
+#include <trace.h>
+#include <critical.h>
 
-extern void ctxsw(void *, void *, uchar);
+extern void ctxsw(void *, void *, uint *);
 int resdefer;                   /* >0 if rescheduling deferred */
+ulong cr3reloads;               /* switches which reloaded CR3 */
 
 /**
  * @ingroup threads
@@ -24,7 +27,6 @@ int resdefer;                   /* >0 if rescheduling deferred */
  */
 int resched(void)
 {
-    uchar asid;                 /* address space identifier */
     struct thrent *throld;      /* old thread entry */
     struct thrent *thrnew;      /* new thread entry */
 
@@ -40,35 +42,31 @@ int resched(void)
 
     if (THRCURR == throld->state)
     {
-        if (nonempty(readylist) && (throld->prio > firstkey(readylist)))
+        if (prio2level(throld->prio) > readyfirst())
         {
             restore(throld->intmask);
             return OK;
         }
         throld->state = THRREADY;
-        insert(thrcurrent, readylist, throld->prio);
+        readyinsert(thrcurrent, throld->prio);
     }
 
     /* get highest priority thread from ready list */
-    thrcurrent = dequeue(readylist);
+    thrcurrent = readydequeue();
     thrnew = &thrtab[thrcurrent];
     thrnew->state = THRCURR;
 
-    kprintf("Rescheduling to thread %d, %s\n", thrcurrent, thrnew->name);
+    SCHED_TRACE("Rescheduling to thread %d, %s", thrcurrent, thrnew->name);
 
-    // Debugging
-    if(thrcurrent == 2) {
-      asm("nop");
-      kprintf("thrcurrent is 222222\n");
-    }
+#if IRQPROF
+    csswitches++;
+    /* each thread resumes inside the sections it switched out in */
+    throld->csdepth = csdepth;
+    csdepth = thrnew->csdepth;
+#endif
 
-    // Reload the CR3 register to hold the new thread's page directory address
-    loadCR3(thrnew->pagedir);
-    asm("nop");
-    
-    /* change address space identifier to thread id */    
-    asid = thrcurrent & 0xff;
-    ctxsw(&throld->stkptr, &thrnew->stkptr, asid);
+    // ctxsw() loads the new thread's page directory into CR3 between the two stacks
+    ctxsw(&throld->stkptr, &thrnew->stkptr, thrnew->pagedir);
 
     /* old thread returns here when resumed */
     restore(throld->intmask);
@@ -0,0 +1,43 @@
+/**
+ * @file sbrk.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <memory.h>
+#include <thread.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Move the break of the current thread by @p incr bytes.  See brk().
+ *
+ * @param incr
+ *      bytes to add to the heap, or to take away if negative; the new
+ *      break is rounded up to a page boundary
+ *
+ * @return
+ *      the break before it was moved, which with a positive @p incr is the
+ *      start of the new memory; ::SYSERR if the break could not be moved.
+ */
+void *sbrk(int incr)
+{
+    struct thrent *thread;
+    irqmask im;
+    uint oldbrk;
+
+    thread = &thrtab[thrcurrent];
+
+    im = disable();
+    oldbrk = thread->brk;
+    if (((incr > 0) && (oldbrk + incr < oldbrk))
+        || ((incr < 0) && (oldbrk + incr > oldbrk))
+        || (SYSERR == brk((void *)(oldbrk + incr))))
+    {
+        restore(im);
+        return (void *)SYSERR;
+    }
+    restore(im);
+    return (void *)oldbrk;
+}
@@ -5,11 +5,14 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <thread.h>
+#include <critical.h>
 
 /**
  * @ingroup threads
  *
- * Send a message to another thread
+ * Send a message to another thread without waiting.  If the thread has a
+ * message ring (see msgqueue()) the message is queued behind any others;
+ * if there is no room, it is dropped and counted in the thread's msgdrops.
  * @param tid thread id of recipient
  * @param msg contents of message
  * @return OK on success, SYSERR on failure
@@ -19,31 +22,30 @@ syscall send(tid_typ tid, message msg)
     register struct thrent *thrptr;
     irqmask im;
 
-    im = disable();
+    im = CS_DISABLE();
     if (isbadtid(tid))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
     thrptr = &thrtab[tid];
-    if ((THRFREE == thrptr->state) || thrptr->hasmsg)
+    if (THRFREE == thrptr->state)
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
-    thrptr->msg = msg;          /* deposit message                */
-    thrptr->hasmsg = TRUE;      /* raise message flag             */
-
-    /* if receiver waits, start it */
-    if (THRRECV == thrptr->state)
+    if ((0 == thrptr->msgqmax) ? thrptr->hasmsg
+        : (semtab[thrptr->msgqroom].count <= 0))
     {
-        ready(tid, RESCHED_YES);
+        thrptr->msgdrops++;
+        CS_RESTORE(im);
+        return SYSERR;
     }
-    else if (THRTMOUT == thrptr->state)
+    if (thrptr->msgqmax > 0)
     {
-        unsleep(tid);
-        ready(tid, RESCHED_YES);
+        wait(thrptr->msgqroom); /* there is room, so this won't block */
     }
-    restore(im);
+    msgdeposit(tid, msg);
+    CS_RESTORE(im);
     return OK;
 }
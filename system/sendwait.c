@@ -0,0 +1,51 @@
+/**
+ * @file sendwait.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <thread.h>
+
+/**
+ * @ingroup threads
+ *
+ * Send a message to another thread, waiting for room in its message ring
+ * rather than dropping the message as send() does.  A thread without a
+ * ring, see msgqueue(), is sent to as with send().
+ * @param tid thread id of recipient
+ * @param msg contents of message
+ * @return OK on success, SYSERR if the recipient is invalid, was killed
+ *         while waiting, or has no ring and a message already waiting
+ */
+syscall sendwait(tid_typ tid, message msg)
+{
+    register struct thrent *thrptr;
+    irqmask im;
+    semaphore room;
+
+    im = disable();
+    if (isbadtid(tid))
+    {
+        restore(im);
+        return SYSERR;
+    }
+    thrptr = &thrtab[tid];
+    if (0 == thrptr->msgqmax)
+    {
+        restore(im);
+        return send(tid, msg);
+    }
+
+    /* The semaphore is freed, waking us, if the recipient is killed */
+    room = thrptr->msgqroom;
+    wait(room);
+    if (isbadtid(tid) || (0 == thrptr->msgqmax)
+        || (room != thrptr->msgqroom))
+    {
+        restore(im);
+        return SYSERR;
+    }
+    msgdeposit(tid, msg);
+    restore(im);
+    return OK;
+}
@@ -0,0 +1,117 @@
+/**
+ * @file shmattach.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <framealloc.h>
+#include <memory.h>
+#include <paging.h>
+#include <shm.h>
+#include <thread.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Map a shared memory segment into the calling thread's address space.
+ * Every thread which attaches the segment sees the same frames, and writes
+ * from any of them are visible to the rest without copying.  A thread
+ * created with clone() inherits the mappings of its parent.
+ *
+ * @param shmid
+ *      segment to attach, as returned by shmget()
+ * @param addr
+ *      page-aligned user address to map the segment at, or NULL to have a
+ *      range set aside from the thread's heap.  An address given by the
+ *      caller must lie in heap memory it has allocated, since the heap
+ *      would otherwise hand the range out again; whatever was resident
+ *      there is released.
+ *
+ * @return
+ *      the address the segment was mapped at, or ::SYSERR if @p shmid is
+ *      not a segment, @p addr is unsuitable, the thread already has
+ *      ::NSHMMAP segments attached, or there is no memory for the mapping.
+ */
+void *shmattach(int shmid, void *addr)
+{
+    irqmask im;
+    struct thrent *thread;
+    struct shment *shmptr;
+    struct shmmap *map;
+    void *reserve = NULL;
+    uint start, nbytes, i;
+
+    thread = &thrtab[thrcurrent];
+
+    im = disable();
+
+    if (isbadshm(shmid))
+    {
+        restore(im);
+        return (void *)SYSERR;
+    }
+    shmptr = &shmtab[shmid];
+    nbytes = shmptr->npages * FRAME_SIZE;
+
+    for (i = 0; i < NSHMMAP; i++)
+    {
+        if (0 == thread->shmmaps[i].addr)
+        {
+            break;
+        }
+    }
+    if (NSHMMAP == i)
+    {
+        restore(im);
+        return (void *)SYSERR;
+    }
+    map = &thread->shmmaps[i];
+
+    if (NULL == addr)
+    {
+        /* One page spare lets the mapping start on a page boundary  */
+        reserve = memget(nbytes + FRAME_SIZE);
+        if (SYSERR == (int)reserve)
+        {
+            restore(im);
+            return (void *)SYSERR;
+        }
+        start = truncframe((uint)reserve + FRAME_SIZE - 1);
+    }
+    else
+    {
+        start = (uint)addr;
+        if ((start & (FRAME_SIZE - 1)) || start < USERSPACE_BASE
+            || start > thread->brk || nbytes > thread->brk - start)
+        {
+            restore(im);
+            return (void *)SYSERR;
+        }
+    }
+
+    thread->rss -= pagerelease(start, start + nbytes);
+    for (i = 0; i < shmptr->npages; i++)
+    {
+        if (SYSERR == pagemap(start + i * FRAME_SIZE,
+                              shmptr->frameaddr + i * FRAME_SIZE,
+                              PAGE_SHARED))
+        {
+            /* Back out the pages mapped so far  */
+            pagerelease(start, start + i * FRAME_SIZE);
+            if (NULL != reserve)
+            {
+                memfree(reserve, nbytes + FRAME_SIZE);
+            }
+            restore(im);
+            return (void *)SYSERR;
+        }
+    }
+    thread->rss += shmptr->npages;
+
+    map->addr = start;
+    map->npages = shmptr->npages;
+    map->reserve = reserve;
+
+    restore(im);
+    return (void *)start;
+}
@@ -0,0 +1,64 @@
+/**
+ * @file shmdetach.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <framealloc.h>
+#include <memory.h>
+#include <paging.h>
+#include <shm.h>
+#include <thread.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Unmap a shared memory segment from the calling thread's address space,
+ * dropping its references on the segment's frames.  A range set aside by
+ * shmattach() is returned to the heap.  Segments still attached when a
+ * thread exits are unmapped with the rest of its address space.
+ *
+ * @param addr
+ *      address the segment was attached at, as returned by shmattach()
+ *
+ * @return
+ *      ::OK on success; ::SYSERR if no segment is attached at @p addr.
+ */
+syscall shmdetach(void *addr)
+{
+    irqmask im;
+    struct thrent *thread;
+    struct shmmap *map;
+    uint i;
+
+    thread = &thrtab[thrcurrent];
+
+    im = disable();
+
+    for (i = 0; i < NSHMMAP; i++)
+    {
+        if (0 != (uint)addr && (uint)addr == thread->shmmaps[i].addr)
+        {
+            break;
+        }
+    }
+    if (NSHMMAP == i)
+    {
+        restore(im);
+        return SYSERR;
+    }
+    map = &thread->shmmaps[i];
+
+    thread->rss -= pagerelease(map->addr,
+                               map->addr + map->npages * FRAME_SIZE);
+    if (NULL != map->reserve)
+    {
+        memfree(map->reserve, map->npages * FRAME_SIZE + FRAME_SIZE);
+    }
+    map->addr = 0;
+    map->npages = 0;
+    map->reserve = NULL;
+
+    restore(im);
+    return OK;
+}
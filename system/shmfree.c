@@ -0,0 +1,45 @@
+/**
+ * @file shmfree.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <framealloc.h>
+#include <shm.h>
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Free a shared memory segment previously allocated with shmget().  Its key
+ * and id may be reused at once, but threads which have the segment attached
+ * keep their mappings; each frame is returned to the frame allocator when
+ * the last of them detaches or exits.
+ *
+ * @param shmid
+ *      The segment to free.
+ *
+ * @return
+ *      ::OK on success; ::SYSERR on failure (@p shmid did not specify a
+ *      valid, allocated segment).
+ */
+syscall shmfree(int shmid)
+{
+    struct shment *shmptr;
+    irqmask im;
+
+    im = disable();
+
+    if (isbadshm(shmid))
+    {
+        restore(im);
+        return SYSERR;
+    }
+    shmptr = &shmtab[shmid];
+
+    /* drop the segment's own reference on its frames  */
+    freeframe_n(shmptr->frameaddr, shmptr->npages);
+    shmptr->state = SHMFREE;
+
+    restore(im);
+    return OK;
+}
@@ -0,0 +1,118 @@
+/**
+ * @file shmget.c
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <framealloc.h>
+#include <paging.h>
+#include <shm.h>
+#include <stdlib.h>
+
+static int shmalloc(void);
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Look up or create a shared memory segment.  A new segment is backed by
+ * zeroed contiguous frames straight away; it is not mapped anywhere until
+ * shmattach().
+ *
+ * @param key
+ *      key naming the segment, or ::SHM_PRIVATE to always create a new one
+ * @param nbytes
+ *      size of the segment, rounded up to whole pages
+ *
+ * @return
+ *      the id of the segment with @p key if there is one at least
+ *      @p nbytes long, otherwise the id of a new segment.  ::SYSERR if
+ *      @p nbytes was 0, the segment with @p key is too small, or no segment
+ *      or frames are free.
+ */
+int shmget(int key, uint nbytes)
+{
+    irqmask im;
+    int shmid;
+    struct shment *shmptr;
+    uint npages, i;
+    void *page;
+
+    if (0 == nbytes)
+    {
+        return SYSERR;
+    }
+    npages = (nbytes + FRAME_SIZE - 1) / FRAME_SIZE;
+
+    im = disable();
+
+    /* Hand out the existing segment with this key  */
+    if (SHM_PRIVATE != key)
+    {
+        for (shmid = 0; shmid < NSHM; shmid++)
+        {
+            shmptr = &shmtab[shmid];
+            if (SHMUSED == shmptr->state && key == shmptr->key)
+            {
+                restore(im);
+                return (npages > shmptr->npages) ? SYSERR : shmid;
+            }
+        }
+    }
+
+    shmid = shmalloc();
+    if (SYSERR == shmid)
+    {
+        restore(im);
+        return SYSERR;
+    }
+    shmptr = &shmtab[shmid];
+
+    /* The segment holds the first reference on each of its frames  */
+    shmptr->frameaddr = framealloc_n(npages);
+    if (SYSERR == shmptr->frameaddr)
+    {
+        shmptr->state = SHMFREE;
+        restore(im);
+        return SYSERR;
+    }
+    for (i = 0; i < npages; i++)
+    {
+        page = kmap(shmptr->frameaddr + i * FRAME_SIZE);
+        if (NULL == page)
+        {
+            freeframe_n(shmptr->frameaddr, npages);
+            shmptr->state = SHMFREE;
+            restore(im);
+            return SYSERR;
+        }
+        bzero(page, FRAME_SIZE);
+        kunmap(page);
+    }
+    shmptr->key = key;
+    shmptr->npages = npages;
+
+    restore(im);
+    return shmid;
+}
+
+/* Returns the index of an unused segment table entry, or SYSERR if none are
+ * available.  */
+static int shmalloc(void)
+{
+#if NSHM
+    int i;
+    static int nextshm = 0;
+
+    /* Check all NSHM slots, starting at 1 past the last slot searched.  */
+    for (i = 0; i < NSHM; i++)
+    {
+        nextshm = (nextshm + 1) % NSHM;
+        if (SHMFREE == shmtab[nextshm].state)
+        {
+            shmtab[nextshm].state = SHMUSED;
+            return nextshm;
+        }
+    }
+#endif
+    return SYSERR;
+}
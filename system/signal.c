@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <thread.h>
+#include <critical.h>
 
 /**
  * @ingroup semaphores
@@ -27,10 +28,10 @@ syscall signal(semaphore sem)
     register struct sement *semptr;
     irqmask im;
 
-    im = disable();
+    im = CS_DISABLE();
     if (isbadsem(sem))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
     semptr = &semtab[sem];
@@ -38,6 +39,6 @@ syscall signal(semaphore sem)
     {
         ready(dequeue(semptr->queue), RESCHED_YES);
     }
-    restore(im);
+    CS_RESTORE(im);
     return OK;
 }
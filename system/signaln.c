@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <thread.h>
+#include <critical.h>
 
 /**
  * @ingroup semaphores
@@ -29,10 +30,10 @@ syscall signaln(semaphore sem, int count)
     register struct sement *semptr;
     irqmask im;
 
-    im = disable();
+    im = CS_DISABLE();
     if (isbadsem(sem) || (count <= 0))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
     semptr = &semtab[sem];
@@ -44,6 +45,6 @@ syscall signaln(semaphore sem, int count)
         }
     }
     resched();
-    restore(im);
+    CS_RESTORE(im);
     return OK;
 }
@@ -0,0 +1,117 @@
+/**
+ * @file slab.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <interrupt.h>
+#include <memory.h>
+#include <thread.h>
+#include <trace.h>
+
+/* Size class holding blocks of nbytes */
+static int slabclass(uint nbytes)
+{
+    int class = 0;
+
+    nbytes = (nbytes - 1) >> SLAB_MINSHIFT;
+    while (nbytes != 0)
+    {
+        class++;
+        nbytes >>= 1;
+    }
+    return class;
+}
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Size of the slab objects used for a small request.
+ *
+ * @param nbytes
+ *      Number of bytes requested, at most ::SLAB_MAXSIZE.
+ *
+ * @return
+ *      @p nbytes rounded up to its size class.
+ */
+uint slabsize(uint nbytes)
+{
+    return 1 << (SLAB_MINSHIFT + slabclass(nbytes));
+}
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Allocate a small object from the current thread's slab free list for its
+ * size class.  When the list is empty, ::SLAB_CHUNK bytes are taken from the
+ * thread's memlist and carved into objects of that class.
+ *
+ * @param nbytes
+ *      Number of bytes requested, at most ::SLAB_MAXSIZE.
+ *
+ * @return
+ *      ::SYSERR if a new slab could not be allocated; otherwise a pointer to
+ *      an 8-byte aligned object of slabsize(@p nbytes) bytes.
+ */
+void *slabget(uint nbytes)
+{
+    struct thrent *thread;
+    int class;
+    uint size;
+    char *chunk, *obj;
+    irqmask im;
+
+    thread = &thrtab[thrcurrent];
+    class = slabclass(nbytes);
+    size = 1 << (SLAB_MINSHIFT + class);
+
+    im = disable();
+    if (NULL == thread->slabfree[class])
+    {
+        chunk = memget(SLAB_CHUNK);
+        if (SYSERR == (int)chunk)
+        {
+            restore(im);
+            return (void *)SYSERR;
+        }
+
+        /* Push objects last first, so they are handed out in order */
+        for (obj = chunk + SLAB_CHUNK - size; obj >= chunk; obj -= size)
+        {
+            *(void **)obj = thread->slabfree[class];
+            thread->slabfree[class] = obj;
+        }
+        MEM_TRACE("slab of %u byte objects at 0x%08X", size, chunk);
+    }
+
+    obj = thread->slabfree[class];
+    thread->slabfree[class] = *(void **)obj;
+    restore(im);
+    return obj;
+}
+
+/**
+ * @ingroup memory_mgmt
+ *
+ * Return a small object to the current thread's slab free list for its size
+ * class.  Slab memory is kept for reuse rather than returned to the memlist.
+ *
+ * @param memptr
+ *      Pointer to an object from slabget().
+ * @param nbytes
+ *      Size of the object, in bytes.  (Same value passed to slabget().)
+ */
+void slabfree(void *memptr, uint nbytes)
+{
+    struct thrent *thread;
+    int class;
+    irqmask im;
+
+    thread = &thrtab[thrcurrent];
+    class = slabclass(nbytes);
+
+    im = disable();
+    *(void **)memptr = thread->slabfree[class];
+    thread->slabfree[class] = memptr;
+    restore(im);
+}
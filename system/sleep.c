@@ -10,6 +10,8 @@
 #include <thread.h>
 #include <queue.h>
 #include <clock.h>
+#include <timer.h>
+#include <critical.h>
 
 /**
  * @ingroup threads
@@ -32,19 +34,15 @@ syscall sleep(uint ms)
 
     ticks = (ms * CLKTICKS_PER_SEC) / 1000;
 
-    im = disable();
+    im = CS_DISABLE();
     if (ticks > 0)
     {
-        if (SYSERR == insertd(thrcurrent, sleepq, ticks))
-        {
-            restore(im);
-            return SYSERR;
-        }
+        tmset(&thrtab[thrcurrent].timer, ticks, wakeup, thrcurrent);
         thrtab[thrcurrent].state = THRSLEEP;
     }
 
     resched();
-    restore(im);
+    CS_RESTORE(im);
     return OK;
 #else
     return SYSERR;
@@ -0,0 +1,234 @@
+/**
+ * @file timer.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <interrupt.h>
+#include <timer.h>
+
+/** Ticks processed by the timer wheel since boot */
+volatile ulong tmticks;
+
+/* Sentinel heads of the circular slot lists */
+static struct tment tmwheel[TMLEVELS][TMSLOTS];
+
+static void tmplace(struct tment *);
+static void tmcascade(int);
+
+/**
+ * @ingroup timer
+ *
+ * Initialize the timer wheel.  This function is called at startup.
+ */
+void tminit(void)
+{
+    int level, slot;
+
+    tmticks = 0;
+    for (level = 0; level < TMLEVELS; level++)
+    {
+        for (slot = 0; slot < TMSLOTS; slot++)
+        {
+            tmwheel[level][slot].next = &tmwheel[level][slot];
+            tmwheel[level][slot].prev = &tmwheel[level][slot];
+        }
+    }
+}
+
+/**
+ * @ingroup timer
+ *
+ * Start a timer, restarting it if it is already pending.
+ * @param tm     timer to start
+ * @param ticks  clock ticks until expiry; 0 is treated as 1
+ * @param func   function to call on expiry
+ * @param arg    argument passed to func
+ */
+void tmset(struct tment *tm, ulong ticks, void (*func) (int), int arg)
+{
+    irqmask im;
+
+    im = disable();
+    if (tmpending(tm))
+    {
+        tmcancel(tm);
+    }
+    if (0 == ticks)
+    {
+        ticks = 1;
+    }
+    tm->expires = tmticks + ticks;
+    tm->func = func;
+    tm->arg = arg;
+    tmplace(tm);
+    restore(im);
+}
+
+/**
+ * @ingroup timer
+ *
+ * Stop a timer.  Cancelling a timer which is not pending has no effect.
+ * @param tm  timer to stop
+ */
+void tmcancel(struct tment *tm)
+{
+    irqmask im;
+
+    im = disable();
+    if (tmpending(tm))
+    {
+        tm->prev->next = tm->next;
+        tm->next->prev = tm->prev;
+        tm->next = NULL;
+        tm->prev = NULL;
+    }
+    restore(im);
+}
+
+/**
+ * @ingroup timer
+ *
+ * Ticks left before a timer fires.
+ * @param tm  timer to query
+ * @return ticks until expiry, or 0 if the timer is not pending
+ */
+ulong tmremain(struct tment *tm)
+{
+    if (!tmpending(tm))
+    {
+        return 0;
+    }
+    return tm->expires - tmticks;
+}
+
+/**
+ * @ingroup timer
+ *
+ * Advance the timer wheel by one tick and call the functions of any timers
+ * which expire.  Called from the clock interrupt.
+ */
+void tmtick(void)
+{
+    struct tment *head, *tm;
+    int level;
+
+    tmticks++;
+
+    /* Pull down the next slot of each level whose lower level wrapped */
+    for (level = 1; level < TMLEVELS; level++)
+    {
+        if (0 != (tmticks & ((1UL << (TMSLOTBITS * level)) - 1)))
+        {
+            break;
+        }
+        tmcascade(level);
+    }
+
+    head = &tmwheel[0][tmticks & (TMSLOTS - 1)];
+    while (head->next != head)
+    {
+        tm = head->next;
+        tmcancel(tm);
+        (*tm->func) (tm->arg);
+    }
+}
+
+/**
+ * @ingroup timer
+ *
+ * Ticks until the wheel next needs attention: the first level 0 timer due
+ * or the next cascade, whichever is sooner.  Used by a tickless clock to
+ * decide when to interrupt next.
+ * @param max  largest value to return
+ * @return ticks from now, at least 1 and at most max
+ */
+ulong tmnext(ulong max)
+{
+    ulong ticks;
+    struct tment *head;
+
+    for (ticks = 1; ticks < max; ticks++)
+    {
+        /* a level 0 wrap may cascade timers due soon */
+        if (0 == ((tmticks + ticks) & (TMSLOTS - 1)))
+        {
+            break;
+        }
+        head = &tmwheel[0][(tmticks + ticks) & (TMSLOTS - 1)];
+        if (head->next != head)
+        {
+            break;
+        }
+    }
+    return ticks;
+}
+
+/*
+ * Put a timer in the slot for its expiry.  The level is picked by how far
+ * away the expiry is; at level n the slot is bits 6n..6n+5 of the expiry.
+ * Interrupts must be disabled.
+ */
+static void tmplace(struct tment *tm)
+{
+    struct tment *head;
+    ulong delta, when;
+    int level;
+
+    when = tm->expires;
+    delta = when - tmticks;
+    if (delta > TMMAXTICKS)
+    {
+        /* Park it at the far edge; it is placed again when cascaded */
+        when = tmticks + TMMAXTICKS;
+        delta = TMMAXTICKS;
+    }
+
+    for (level = 0; level < TMLEVELS - 1; level++)
+    {
+        if (delta < (1UL << (TMSLOTBITS * (level + 1))))
+        {
+            break;
+        }
+    }
+    head = &tmwheel[level][(when >> (TMSLOTBITS * level)) & (TMSLOTS - 1)];
+
+    tm->next = head;
+    tm->prev = head->prev;
+    head->prev->next = tm;
+    head->prev = tm;
+}
+
+/*
+ * Move every timer in the current slot of a level back onto the wheel,
+ * which puts each in a lower level now that it is closer.
+ */
+static void tmcascade(int level)
+{
+    struct tment *head, *tm;
+    struct tment list;
+
+    head = &tmwheel[level][(tmticks >> (TMSLOTBITS * level))
+                           & (TMSLOTS - 1)];
+    if (head->next == head)
+    {
+        return;
+    }
+
+    /* Detach the slot first, since timers may land back in it */
+    list.next = head->next;
+    list.prev = head->prev;
+    list.next->prev = &list;
+    list.prev->next = &list;
+    head->next = head;
+    head->prev = head;
+
+    while (list.next != &list)
+    {
+        tm = list.next;
+        list.next = tm->next;
+        tm->next->prev = &list;
+        tmplace(tm);
+    }
+}
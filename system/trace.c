@@ -0,0 +1,96 @@
+/**
+ * @file trace.c
+ * Kernel trace ring buffer.
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <thread.h>
+#include <trace.h>
+#include <tsc.h>
+
+struct tracent tracebuf[TRACE_NENTRY];
+ulong tracenext;                /* sequence number of the next record */
+
+/**
+ * Append a record to the trace ring.  A slot is claimed with an atomic
+ * exchange-and-add on tracenext, so records may be logged from interrupt
+ * handlers and the page fault task without disabling interrupts.  The
+ * record's sequence number is stored last, so tracedump() skips records
+ * still being written.
+ *
+ * TRACE_NARG words are copied from the argument list whether or not fmt
+ * uses them; the extras are never printed.
+ *
+ * @param echo  also print the record with kprintf()
+ * @param fmt   printf-style format string, which must be a literal
+ */
+void tracelog(bool echo, const char *fmt, ...)
+{
+    struct tracent *entry;
+    ulong seq = 1;
+    va_list ap;
+    int i;
+
+    asm volatile ("lock xaddl %0, %1":"+r" (seq), "+m"(tracenext)
+                  ::"memory");
+    entry = &tracebuf[seq % TRACE_NENTRY];
+
+    entry->seq = 0;
+    entry->tsc = rdtsc();
+    entry->tid = thrcurrent;
+    entry->fmt = fmt;
+    va_start(ap, fmt);
+    for (i = 0; i < TRACE_NARG; i++)
+    {
+        entry->args[i] = va_arg(ap, ulong);
+    }
+    va_end(ap);
+    entry->seq = seq + 1;
+
+    if (echo)
+    {
+        kprintf(fmt, entry->args[0], entry->args[1], entry->args[2],
+                entry->args[3]);
+        kprintf("\r\n");
+    }
+}
+
+/**
+ * Print the records in the trace ring, oldest first.
+ */
+void tracedump(void)
+{
+    struct tracent *entry;
+    ulong seq, last, start;
+
+    last = tracenext;
+    start = (last > TRACE_NENTRY) ? last - TRACE_NENTRY : 0;
+    for (seq = start; seq < last; seq++)
+    {
+        entry = &tracebuf[seq % TRACE_NENTRY];
+        /* Skip records being written or already overwritten */
+        if (entry->seq != seq + 1)
+        {
+            continue;
+        }
+        printf("%10u %3d ", (uint)entry->tsc, entry->tid);
+        printf(entry->fmt, entry->args[0], entry->args[1], entry->args[2],
+               entry->args[3]);
+        printf("\n");
+    }
+}
+
+/**
+ * Discard every record in the trace ring.
+ */
+void traceclear(void)
+{
+    int i;
+
+    for (i = 0; i < TRACE_NENTRY; i++)
+    {
+        tracebuf[i].seq = 0;
+    }
+}
@@ -4,6 +4,8 @@
 /* Embedded Xinu, Copyright (C) 2009, 2013.  All rights reserved. */
 
 #include <monitor.h>
+#include <queue.h>
+#include <critical.h>
 
 /**
  * @ingroup monitors
@@ -13,8 +15,9 @@
  * The monitor's lock count (indicating the number of times the owning thread
  * has locked the monitor) is decremented.  If the count remains greater than
  * zero, no further action is taken.  If the count reaches zero, the monitor is
- * set to unowned and up to one thread that may be waiting to lock() the monitor
- * is awakened.
+ * handed to the highest priority thread waiting to lock() it, or set to
+ * unowned if there is none, and the previous owner drops any priority it
+ * inherited through the monitor.
  *
  * This normally should be called by the owning thread of the monitor
  * subsequently to a lock() by the same thread, but this also may be called
@@ -31,12 +34,14 @@
 syscall unlock(monitor mon)
 {
     register struct monent *monptr;
+    struct sement *semptr;
+    tid_typ owner, tid;
     irqmask im;
 
-    im = disable();
+    im = CS_DISABLE();
     if (isbadmon(mon))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
 
@@ -45,7 +50,7 @@ syscall unlock(monitor mon)
     /* safety check: monitor must be locked at least once  */
     if (monptr->count == 0)
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
 
@@ -55,10 +60,28 @@ syscall unlock(monitor mon)
     /* if this is the top-level unlock call, then free this monitor's lock */
     if (monptr->count == 0)
     {
-        monptr->owner = NOOWNER;
-        signal(monptr->sem);
+        owner = monptr->owner;
+        semptr = &semtab[monptr->sem];
+        if (nonempty(semptr->queue))
+        {
+            /* the waiter returns from lock() owning the monitor */
+            tid = dequeue(semptr->queue);
+            (semptr->count)++;
+            monptr->owner = tid;
+            monptr->count = 1;
+            thrtab[tid].monwait = NOMON;
+            moninherit(tid);
+            ready(tid, RESCHED_NO);
+        }
+        else
+        {
+            monptr->owner = NOOWNER;
+            signal(monptr->sem);
+        }
+        moninherit(owner);
+        resched();
     }
 
-    restore(im);
+    CS_RESTORE(im);
     return OK;
 }
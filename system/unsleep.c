@@ -8,13 +8,13 @@
 #include <stddef.h>
 #include <interrupt.h>
 #include <thread.h>
-#include <queue.h>
 #include <clock.h>
+#include <timer.h>
 
 /**
  * @ingroup threads
  *
- * Remove thread from the sleep queue prematurely
+ * Cancel a thread's sleep or receive timeout prematurely
  * @param tid  target thread
  * @return OK if thread removed, else SYSERR
  */
@@ -22,7 +22,6 @@ syscall unsleep(tid_typ tid)
 {
     register struct thrent *thrptr;
     irqmask im;
-    tid_typ next = 0;
 
     im = disable();
 
@@ -33,19 +32,14 @@ syscall unsleep(tid_typ tid)
     }
 
     thrptr = &thrtab[tid];
-    if ((thrptr->state != THRSLEEP) && (thrptr->state != THRTMOUT))
+    if ((thrptr->state != THRSLEEP) && (thrptr->state != THRTMOUT)
+        && (thrptr->state != THRMBOX))
     {
         restore(im);
         return SYSERR;
     }
 
-    next = quetab[tid].next;
-    if (next < NTHREAD)
-    {
-        quetab[next].key += quetab[tid].key;
-    }
-
-    getitem(tid);
+    tmcancel(&thrptr->timer);
     restore(im);
     return OK;
 }
@@ -5,6 +5,7 @@
 /* Embedded Xinu, Copyright (C) 2009.  All rights reserved. */
 
 #include <thread.h>
+#include <critical.h>
 
 /**
  * @ingroup semaphores
@@ -29,10 +30,10 @@ syscall wait(semaphore sem)
     register struct thrent *thrptr;
     irqmask im;
 
-    im = disable();
+    im = CS_DISABLE();
     if (isbadsem(sem))
     {
-        restore(im);
+        CS_RESTORE(im);
         return SYSERR;
     }
     thrptr = &thrtab[thrcurrent];
@@ -44,6 +45,6 @@ syscall wait(semaphore sem)
         enqueue(thrcurrent, semptr->queue);
         resched();
     }
-    restore(im);
+    CS_RESTORE(im);
     return OK;
 }
@@ -0,0 +1,113 @@
+/**
+ * @file waittime.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <conf.h>
+#include <stddef.h>
+#include <thread.h>
+#include <clock.h>
+#include <timer.h>
+#include <critical.h>
+
+#if RTCLOCK
+static void waitexpire(int);
+#endif
+
+/**
+ * @ingroup semaphores
+ *
+ * Wait on a semaphore, giving up after the given time.
+ *
+ * This is wait() with a timeout, made with the thread's timer like
+ * recvtime().  A thread which times out is taken off the semaphore's queue
+ * and its claim on the count is given back, so it never consumes a later
+ * signal().  Threads waiting with and without a timeout share the queue in
+ * order of arrival.
+ *
+ * @param sem
+ *      Semaphore to wait on.
+ * @param maxwait
+ *      Ticks to wait before timing out.
+ *
+ * @return
+ *      ::OK if the semaphore was signaled, or freed with semfree();
+ *      ::TIMEOUT if @p maxwait ran out first; ::SYSERR if @p sem did not
+ *      specify a valid semaphore, @p maxwait was negative, or there is no
+ *      clock to time the wait with.
+ */
+syscall waittime(semaphore sem, int maxwait)
+{
+    register struct sement *semptr;
+    register struct thrent *thrptr;
+    irqmask im;
+    int retval;
+
+    if (maxwait < 0)
+    {
+        return SYSERR;
+    }
+
+    im = CS_DISABLE();
+    if (isbadsem(sem))
+    {
+        CS_RESTORE(im);
+        return SYSERR;
+    }
+    thrptr = &thrtab[thrcurrent];
+    semptr = &semtab[sem];
+    retval = OK;
+    if (semptr->count <= 0)
+    {
+#if RTCLOCK
+        if (0 == maxwait)
+        {
+            CS_RESTORE(im);
+            return TIMEOUT;
+        }
+        semptr->count--;
+        thrptr->state = THRWAIT;
+        thrptr->sem = sem;
+        enqueue(thrcurrent, semptr->queue);
+        tmset(&thrptr->timer, maxwait, waitexpire, thrcurrent);
+        resched();
+
+        /* waitexpire() leaves sem invalid when it took us off the queue */
+        tmcancel(&thrptr->timer);
+        if (SYSERR == (int)thrptr->sem)
+        {
+            retval = TIMEOUT;
+        }
+#else
+        CS_RESTORE(im);
+        return SYSERR;
+#endif
+    }
+    else
+    {
+        semptr->count--;
+    }
+    CS_RESTORE(im);
+    return retval;
+}
+
+#if RTCLOCK
+/*
+ * Timer function for waittime(): give up a thread's place on the semaphore
+ * queue if it is still waiting there.  A thread already readied by signal()
+ * is left alone.  Called from the clock interrupt, so the caller reschedules.
+ */
+static void waitexpire(int tid)
+{
+    struct thrent *thrptr = &thrtab[tid];
+
+    if (THRWAIT == thrptr->state)
+    {
+        getitem(tid);
+        semtab[thrptr->sem].count++;
+        thrptr->sem = SYSERR;
+        ready(tid, RESCHED_NO);
+    }
+}
+#endif /* RTCLOCK */
@@ -6,7 +6,6 @@
 
 #include <stddef.h>
 #include <thread.h>
-#include <queue.h>
 #include <clock.h>
 
 #if RTCLOCK
@@ -14,16 +13,13 @@
 /**
  * @ingroup threads
  *
- * Wakeup and ready all threads that have no more time to sleep
+ * Timer function for sleep() and recvtime(): ready a thread whose time is up.
+ * Called from the clock interrupt, so the caller reschedules.
+ * @param tid  thread to wake
  */
-void wakeup(void)
+void wakeup(int tid)
 {
-    while (nonempty(sleepq) && (firstkey(sleepq) <= 0))
-    {
-        ready(dequeue(sleepq), RESCHED_NO);
-    }
-
-    resched();
+    ready((tid_typ)tid, RESCHED_NO);
 }
 
 #endif /* RTCLOCK */
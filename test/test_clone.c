@@ -0,0 +1,107 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <memory.h>
+#include <framealloc.h>
+#include <testsuite.h>
+#include <thread.h>
+#include <tsc.h>
+
+#define CLONEHEAP   (16 * FRAME_SIZE)   /* bytes of heap shared with child */
+
+static thread clonechild(uchar *block, tid_typ parent)
+{
+    uint i;
+    bool same = TRUE;
+
+    for (i = 0; i < CLONEHEAP; i++)
+    {
+        if (block[i] != (uchar)i)
+        {
+            same = FALSE;
+        }
+    }
+    /* Should only change the child's copy */
+    block[0] = 0xFF;
+    send(parent, same && (0xFF == block[0]));
+    return OK;
+}
+
+static thread cloneexit(void)
+{
+    return OK;
+}
+
+/**
+ * Checks that a cloned thread sees the parent's heap, that its writes stay
+ * private, and that the heap is shared rather than copied.  Then compares
+ * the cost of create() and clone().
+ */
+thread test_clone(bool verbose)
+{
+    bool passed = TRUE;
+    tid_typ tid;
+    uint freebefore, used, i, t;
+    uchar *block;
+
+    block = memget(CLONEHEAP);
+    failif(SYSERR == (int)block, "memget failed");
+    if (SYSERR == (int)block)
+    {
+        testFail(TRUE, "");
+        return OK;
+    }
+    for (i = 0; i < CLONEHEAP; i++)
+    {
+        block[i] = (uchar)i;
+    }
+
+    testPrint(verbose, "Clone shares heap without copying");
+    freebefore = numfreeframes;
+    tid = clone((void *)clonechild, thrtab[thrcurrent].prio + 1,
+                "CLONECHILD", 2, block, thrcurrent);
+    used = freebefore - numfreeframes;
+    failif((SYSERR == tid) || (used >= CLONEHEAP / FRAME_SIZE), "");
+
+    if (SYSERR != tid)
+    {
+        testPrint(verbose, "Child reads heap and writes privately");
+        recvclr();
+        ready(tid, RESCHED_YES);
+        failif((TRUE != receive()) || (0 != block[0]), "");
+    }
+
+    testPrint(verbose, "Parent writes to shared heap");
+    block[1] = 0xFF;
+    failif(0xFF != block[1], "");
+    memfree(block, CLONEHEAP);
+
+    if (verbose)
+    {
+        printf("\t%u frames to clone a %u byte heap\n", used, CLONEHEAP);
+
+        t = rdtsc();
+        tid = create((void *)cloneexit, INITSTK,
+                     thrtab[thrcurrent].prio + 1, "CLONEEXIT", 0);
+        t = rdtsc() - t;
+        ready(tid, RESCHED_YES);
+        printf("\tcreate(): %u cycles\n", t);
+
+        t = rdtsc();
+        tid = clone((void *)cloneexit, thrtab[thrcurrent].prio + 1,
+                    "CLONEEXIT", 0);
+        t = rdtsc() - t;
+        ready(tid, RESCHED_YES);
+        printf("\tclone():  %u cycles\n", t);
+    }
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
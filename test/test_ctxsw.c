@@ -0,0 +1,108 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <framealloc.h>
+#include <paging.h>
+#include <testsuite.h>
+#include <thread.h>
+#include <tsc.h>
+
+#define NROUNDS     256         /* switch round trips timed             */
+#define NTOUCH      64          /* kernel pages read after each switch  */
+#define TOUCHBASE   0x00100000  /* first kernel page read               */
+
+static volatile uint touchsum;
+
+/* Read one word from each of NTOUCH identity mapped kernel pages */
+static void touchkernel(void)
+{
+    uint i;
+    uint sum = 0;
+
+    for (i = 0; i < NTOUCH; i++)
+    {
+        sum += *(volatile uint *)(TOUCHBASE + i * FRAME_SIZE);
+    }
+    touchsum = sum;
+}
+
+static thread pingpong(void)
+{
+    while (receive())
+    {
+        touchkernel();
+    }
+    return OK;
+}
+
+/* Time NROUNDS round trips to the partner thread, in cycles per round */
+static uint roundtrips(tid_typ partner)
+{
+    uint i, t;
+
+    t = rdtsc();
+    for (i = 0; i < NROUNDS; i++)
+    {
+        send(partner, 1);
+        touchkernel();
+    }
+    return (rdtsc() - t) / NROUNDS;
+}
+
+/**
+ * Checks that a switch between threads reloads CR3, then compares the cost
+ * of switching between address spaces with the kernel identity mapping
+ * marked global and with global pages disabled.  QEMU does not expose TLB
+ * miss counters, so the cost of the misses is measured directly by
+ * touching kernel pages after every switch.
+ */
+thread test_ctxsw(bool verbose)
+{
+    bool passed = TRUE;
+    ulong reloads;
+    uint withglobal, without;
+    tid_typ partner;
+
+    testPrint(verbose, "Switch to other thread reloads CR3");
+    partner = create((void *)pingpong, INITSTK,
+                     thrtab[thrcurrent].prio + 1, "PINGPONG", 0);
+    failif(SYSERR == partner, "");
+    if (SYSERR != partner)
+    {
+        reloads = cr3reloads;
+        /* Runs now and blocks in receive() */
+        ready(partner, RESCHED_YES);
+        failif(cr3reloads < reloads + 2, "");
+
+        if (enableglobalpages())
+        {
+            withglobal = roundtrips(partner);
+            disableglobalpages();
+            without = roundtrips(partner);
+            enableglobalpages();
+            if (verbose)
+            {
+                printf("\tround trip touching %d kernel pages: %u cycles "
+                       "with global pages, %u without\n",
+                       NTOUCH, withglobal, without);
+            }
+        }
+        else if (verbose)
+        {
+            printf("\tCPU lacks global pages, benchmark skipped\n");
+        }
+
+        send(partner, 0);
+        recvclr();
+    }
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
@@ -0,0 +1,374 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <interrupt.h>
+#include <framealloc.h>
+#include <paging.h>
+#include <platform.h>
+#include <testsuite.h>
+#include <tsc.h>
+
+#define NFILLRUNS   2048        /* most runs recorded while filling     */
+#define FILLRUN     1024        /* frames grabbed per fill allocation   */
+#define NSAMPLES    256         /* allocations timed per occupancy      */
+#define BULKFRAMES  8           /* frames per timed framealloc_n()      */
+#define NDMABUF     64          /* buffers held by the DMA workload     */
+#define DMAROUNDS   4096        /* allocations and frees it performs    */
+#define DMAMAXBUF   16          /* most frames in one DMA buffer        */
+
+struct fillrun
+{
+    uint addr;                  /**< physical address of first frame    */
+    uint nframes;               /**< length of the run in frames        */
+};
+
+static struct fillrun fillruns[NFILLRUNS];
+static struct fillrun dmabufs[NDMABUF];
+static uint samples[NSAMPLES];
+
+static int fill(void);
+static void thin(int nruns, uint occupancy);
+static void release(int nruns);
+static bool measure(bool verbose, uint occupancy);
+static bool dmaworkload(bool verbose);
+
+/**
+ * Benchmarks the frame allocator.  Memory is filled to a target occupancy
+ * with randomly scattered free frames, then the latency of framealloc() and
+ * framealloc_n() is sampled with the time-stamp counter.  A randomized run
+ * of aligned DMA buffer allocations checks that the DMA zone does not
+ * fragment.
+ */
+thread test_framealloc(bool verbose)
+{
+    bool passed = TRUE;
+    uint freebefore, freeafter;
+    uint addr, *frame;
+    ulong calls;
+    irqmask im;
+    int i;
+
+    freebefore = numfreeframes;
+
+    /* Single allocation and release */
+    testPrint(verbose, "Allocate and free single frame");
+    im = disable();
+    addr = framealloc();
+    restore(im);
+    failif((SYSERR == addr) || (addr & (FRAME_SIZE - 1))
+           || (numfreeframes != freebefore - 1), "");
+    im = disable();
+    freeframe(addr);
+    restore(im);
+
+    /* Contiguous allocation and release */
+    testPrint(verbose, "Allocate and free contiguous frames");
+    im = disable();
+    addr = framealloc_n(FILLRUN + 1);
+    restore(im);
+    failif((SYSERR == addr) || (addr & (FRAME_SIZE - 1))
+           || (numfreeframes != freebefore - (FILLRUN + 1)), "");
+    im = disable();
+    freeframe_n(addr, FILLRUN + 1);
+    restore(im);
+
+    /* Zeroed allocation, after dirtying a frame it may well hand back */
+    testPrint(verbose, "Allocate zeroed frame");
+    im = disable();
+    addr = framealloc();
+    frame = kmap(addr);
+    memset(frame, 0xFF, FRAME_SIZE);
+    kunmap(frame);
+    freeframe(addr);
+    calls = zeropoolhits + zeropoolmisses;
+    addr = framealloc_zeroed();
+    frame = kmap(addr);
+    for (i = 0; i < FRAME_SIZE / sizeof(uint); i++)
+    {
+        if (0 != frame[i])
+        {
+            break;
+        }
+    }
+    kunmap(frame);
+    freeafter = numfreeframes;
+    freeframe(addr);
+    restore(im);
+    failif((i != FRAME_SIZE / sizeof(uint))
+           || (zeropoolhits + zeropoolmisses != calls + 1)
+           || (freeafter != freebefore - 1), "");
+
+    /* Ordinary allocations leave the DMA zone alone */
+    testPrint(verbose, "Keep single frames out of DMA zone");
+    im = disable();
+    addr = framealloc();
+    restore(im);
+    failif((SYSERR == addr) || (addr < dmazoneend)
+           || (addr >= (uint)platform.maxaddr), "");
+    im = disable();
+    freeframe(addr);
+    restore(im);
+
+    testPrint(verbose, "Allocate aligned DMA buffer");
+    im = disable();
+    addr = framealloc_contig(3, 16, FRAMEZONE_DMA);
+    restore(im);
+    failif((SYSERR == addr) || (addr >= dmazoneend)
+           || (addr & (16 * FRAME_SIZE - 1))
+           || (numfreeframes != freebefore - 3), "");
+    im = disable();
+    freeframe_n(addr, 3);
+    restore(im);
+
+    testPrint(verbose, "Free count restored");
+    failif(numfreeframes != freebefore, "");
+
+    passed &= dmaworkload(verbose);
+
+    /* Latency at increasing occupancy */
+    passed &= measure(verbose, 10);
+    passed &= measure(verbose, 50);
+    passed &= measure(verbose, 95);
+
+    testPrint(verbose, "Free count restored after benchmark");
+    failif(numfreeframes != freebefore, "");
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
+
+/**
+ * Fill memory to the given occupancy percentage, time allocations there,
+ * and return all frames.
+ */
+static bool measure(bool verbose, uint occupancy)
+{
+    bool passed = TRUE;
+    char str[80];
+    uint totalframes = numframetableentries * 32;
+    uint actual, total, worst, t, hint;
+    int nruns, i;
+    irqmask im;
+
+    sprintf(str, "Allocation latency at %u%% occupancy", occupancy);
+    testPrint(verbose, str);
+
+    im = disable();
+    /* Filling moves the next-fit hint, which is put back afterwards */
+    hint = lastallocatedframe;
+    nruns = fill();
+    thin(nruns, occupancy);
+    actual = ((totalframes - numfreeframes) / (totalframes / 100));
+
+    /* Single frames */
+    total = 0;
+    worst = 0;
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        t = rdtsc();
+        samples[i] = framealloc();
+        t = rdtsc() - t;
+        total += t;
+        if (t > worst)
+        {
+            worst = t;
+        }
+        if (SYSERR == samples[i])
+        {
+            passed = FALSE;
+        }
+    }
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        freeframe(samples[i]);
+    }
+    restore(im);
+
+    failif(!passed, "");
+    if (verbose)
+    {
+        printf("\t%u%% in use: framealloc() avg %u cycles, max %u cycles\n",
+               actual, total / NSAMPLES, worst);
+    }
+
+    /* Short contiguous runs */
+    im = disable();
+    total = 0;
+    worst = 0;
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        t = rdtsc();
+        samples[i] = framealloc_n(BULKFRAMES);
+        t = rdtsc() - t;
+        total += t;
+        if (t > worst)
+        {
+            worst = t;
+        }
+    }
+    for (i = 0; i < NSAMPLES; i++)
+    {
+        if (SYSERR != samples[i])
+        {
+            freeframe_n(samples[i], BULKFRAMES);
+        }
+    }
+    release(nruns);
+    lastallocatedframe = hint;
+    restore(im);
+
+    if (verbose)
+    {
+        printf("\t%u%% in use: framealloc_n(%d) avg %u cycles, max %u cycles\n",
+               actual, BULKFRAMES, total / NSAMPLES, worst);
+    }
+
+    return passed;
+}
+
+/**
+ * Allocate every free frame, recording the runs taken.
+ * @return number of runs recorded in fillruns
+ */
+static int fill(void)
+{
+    int nruns = 0;
+    uint nframes = FILLRUN;
+    uint addr;
+
+    while (nframes > 0 && nruns < NFILLRUNS)
+    {
+        addr = framealloc_n(nframes);
+        if (SYSERR == addr)
+        {
+            nframes /= 2;
+            continue;
+        }
+        fillruns[nruns].addr = addr;
+        fillruns[nruns].nframes = nframes;
+        nruns++;
+    }
+    return nruns;
+}
+
+/**
+ * Free randomly chosen frames from the filled runs until roughly the given
+ * percentage of all frames is in use.
+ */
+static void thin(int nruns, uint occupancy)
+{
+    int i;
+    uint j;
+
+    for (i = 0; i < nruns; i++)
+    {
+        for (j = 0; j < fillruns[i].nframes; j++)
+        {
+            if ((uint)(rand() % 100) >= occupancy)
+            {
+                freeframe(fillruns[i].addr + j * FRAME_SIZE);
+            }
+        }
+    }
+}
+
+/**
+ * Return every frame taken by fill().
+ */
+static void release(int nruns)
+{
+    int i;
+
+    for (i = 0; i < nruns; i++)
+    {
+        freeframe_n(fillruns[i].addr, fillruns[i].nframes);
+    }
+}
+
+/**
+ * Allocate and free DMA buffers of random sizes and alignments, checking
+ * each lands where it should, then check the zone is whole again.
+ */
+static bool dmaworkload(bool verbose)
+{
+    bool passed = TRUE;
+    struct framestat stat;
+    uint dmafree, held, most, failed, nframes, align, freebefore;
+    int i, round;
+    irqmask im;
+
+    testPrint(verbose, "Random DMA buffer workload");
+
+    im = disable();
+    framestat(&stat);
+    dmafree = stat.dmafree;
+    held = 0;
+    most = 0;
+    failed = 0;
+    for (i = 0; i < NDMABUF; i++)
+    {
+        dmabufs[i].nframes = 0;
+    }
+
+    for (round = 0; round < DMAROUNDS; round++)
+    {
+        i = rand() % NDMABUF;
+        if (dmabufs[i].nframes > 0)
+        {
+            freeframe_n(dmabufs[i].addr, dmabufs[i].nframes);
+            held -= dmabufs[i].nframes;
+            dmabufs[i].nframes = 0;
+            continue;
+        }
+
+        nframes = 1 + rand() % DMAMAXBUF;
+        align = 1 << (rand() % 4);
+        freebefore = numfreeframes;
+        dmabufs[i].addr = framealloc_contig(nframes, align, FRAMEZONE_DMA);
+        if (SYSERR == dmabufs[i].addr)
+        {
+            failed++;
+            continue;
+        }
+        dmabufs[i].nframes = nframes;
+        if ((dmabufs[i].addr >= dmazoneend)
+            || (dmabufs[i].addr & (align * FRAME_SIZE - 1))
+            || (numfreeframes != freebefore - nframes))
+        {
+            passed = FALSE;
+        }
+        held += nframes;
+        if (held > most)
+        {
+            most = held;
+        }
+    }
+
+    for (i = 0; i < NDMABUF; i++)
+    {
+        if (dmabufs[i].nframes > 0)
+        {
+            freeframe_n(dmabufs[i].addr, dmabufs[i].nframes);
+        }
+    }
+    framestat(&stat);
+    restore(im);
+
+    failif(!passed || (0 != failed) || (stat.dmafree != dmafree), "");
+    if (verbose)
+    {
+        printf("\t%d rounds: %u failed allocations, at most %u of %u "
+               "free DMA frames held\n", DMAROUNDS, failed, most, dmafree);
+    }
+
+    return passed;
+}
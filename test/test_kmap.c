@@ -0,0 +1,111 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <interrupt.h>
+#include <framealloc.h>
+#include <paging.h>
+#include <testsuite.h>
+#include <thread.h>
+#include <tsc.h>
+
+#define NSPAWNS     32          /* create and kill pairs timed          */
+
+static thread kmapidle(void)
+{
+    return OK;
+}
+
+/**
+ * Checks the temporary kernel mapping slots, then measures how long
+ * interrupts stay disabled across create() and kill() pairs, which edit
+ * foreign page directories through those slots.
+ */
+thread test_kmap(bool verbose)
+{
+    bool passed = TRUE;
+    void *slots[KMAP_SLOTS + 1];
+    uint *first, *second;
+    uint frameaddr, freebefore, total, worst, t;
+    tid_typ tid;
+    irqmask im;
+    int i;
+
+    testPrint(verbose, "Two mappings of one frame agree");
+    im = disable();
+    frameaddr = framealloc();
+    first = kmap(frameaddr);
+    second = kmap(frameaddr);
+    failif((NULL == first) || (NULL == second) || (first == second), "");
+    if ((NULL != first) && (NULL != second))
+    {
+        *first = 0xDEADBEEF;
+        failif(0xDEADBEEF != *second, "");
+    }
+    kunmap(second);
+    kunmap(first);
+    freeframe(frameaddr);
+    restore(im);
+
+    testPrint(verbose, "Slots run out and are released");
+    im = disable();
+    frameaddr = framealloc();
+    for (i = 0; i < KMAP_SLOTS + 1; i++)
+    {
+        slots[i] = kmap(frameaddr);
+    }
+    failif((NULL == slots[KMAP_SLOTS - 1]) || (NULL != slots[KMAP_SLOTS]),
+           "");
+    for (i = 0; i < KMAP_SLOTS; i++)
+    {
+        kunmap(slots[i]);
+    }
+    first = kmap(frameaddr);
+    failif(NULL == first, "");
+    kunmap(first);
+    freeframe(frameaddr);
+    restore(im);
+
+    testPrint(verbose, "Create and kill with interrupts off");
+    freebefore = numfreeframes;
+    total = 0;
+    worst = 0;
+    for (i = 0; i < NSPAWNS; i++)
+    {
+        im = disable();
+        t = rdtsc();
+        tid = create((void *)kmapidle, INITSTK, INITPRIO, "KMAPIDLE", 0);
+        if (SYSERR != tid)
+        {
+            kill(tid);
+        }
+        t = rdtsc() - t;
+        restore(im);
+        recvclr();
+        if (SYSERR == tid)
+        {
+            passed = FALSE;
+            break;
+        }
+        total += t;
+        if (t > worst)
+        {
+            worst = t;
+        }
+    }
+    failif(!passed || (numfreeframes != freebefore), "");
+    if (verbose && passed)
+    {
+        printf("\tcreate()+kill(): avg %u cycles, max %u cycles "
+               "with interrupts disabled\n", total / NSPAWNS, worst);
+    }
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
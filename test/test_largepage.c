@@ -0,0 +1,145 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <interrupt.h>
+#include <memory.h>
+#include <framealloc.h>
+#include <paging.h>
+#include <testsuite.h>
+#include <thread.h>
+#include <tsc.h>
+
+#define CHASEPAGES  4096        /* pages holding one link each (16 MB)  */
+#define CHASESTEP   1031        /* pages between links, prime           */
+#define CHASELAPS   16          /* traversals of the chain timed        */
+#define CHASEBYTES  (CHASEPAGES * FRAME_SIZE + LARGE_PAGE_SIZE)
+#define ZEROWAIT    100         /* 10 ms sleeps waiting on a large page */
+
+/*
+ * Large pages are only used once the null thread has zeroed one, so give
+ * it the time to.
+ */
+static void largewait(void)
+{
+    uint i;
+
+    for (i = 0; i < ZEROWAIT && !framelargeready(); i++)
+    {
+        sleep(10);
+    }
+}
+
+/*
+ * Link one word in each of CHASEPAGES pages into a cycle which visits the
+ * pages CHASESTEP apart, so neither the prefetcher nor the TLB can follow,
+ * then time CHASELAPS traversals.  Links sit at different offsets within
+ * their pages to spread them over the cache sets.
+ */
+static ulong chase(char *block)
+{
+    void **link, **next;
+    ulong t;
+    uint page, i;
+
+    block = (char *)(((uint)block + LARGE_PAGE_SIZE - 1)
+                     & ~(LARGE_PAGE_SIZE - 1));
+    for (i = 0; i < CHASEPAGES; i++)
+    {
+        page = (i * CHASESTEP) % CHASEPAGES;
+        link = (void **)(block + page * FRAME_SIZE + (page % 64) * 64);
+        page = ((i + 1) * CHASESTEP) % CHASEPAGES;
+        next = (void **)(block + page * FRAME_SIZE + (page % 64) * 64);
+        *link = next;
+    }
+
+    link = (void **)block;
+    t = rdtsc();
+    for (i = 0; i < CHASEPAGES * CHASELAPS; i++)
+    {
+        link = *link;
+    }
+    t = rdtsc() - t;
+
+    /* Keep the traversal from being optimised away */
+    if (NULL == link)
+    {
+        printf("broken chain\n");
+    }
+    return t / (CHASEPAGES * CHASELAPS);
+}
+
+/**
+ * Checks that a large heap block is backed with 4 MB pages and that they
+ * are returned when it is freed.  Verbose runs time a pointer chase through
+ * the block with 4 KB pages and with large pages.
+ */
+thread test_largepage(bool verbose)
+{
+    bool passed = TRUE;
+    char *block, *base;
+    uint rss, freebefore;
+    uint *pde;
+    ulong small = 0, large;
+    bool saved;
+
+    if (!largepages)
+    {
+        testSkip(TRUE, "");
+        return OK;
+    }
+
+    testPrint(verbose, "Back big heap block with large pages");
+    largewait();
+    freebefore = numfreeframes;
+    rss = thrtab[thrcurrent].rss;
+    block = memget(CHASEBYTES);
+    failif(SYSERR == (int)block, "");
+    if (SYSERR != (int)block)
+    {
+        base = (char *)(((uint)block + LARGE_PAGE_SIZE - 1)
+                        & ~(LARGE_PAGE_SIZE - 1));
+        base[0] = 1;
+        pde = (uint *)0xFFFFF000 + ((uint)base >> 22);
+        failif((1 != base[0]) || !(*pde & PAGE_LARGE)
+               || (thrtab[thrcurrent].rss < rss + LARGE_FRAMES), "");
+
+        testPrint(verbose, "Free large pages");
+        memfree(block, CHASEBYTES);
+        failif((thrtab[thrcurrent].rss > rss + 2)
+               || (freebefore > numfreeframes + 2), "");
+    }
+
+    if (verbose)
+    {
+        /* The same chase with large pages turned off while it faults in */
+        saved = largepages;
+        largepages = FALSE;
+        block = memget(CHASEBYTES);
+        if (SYSERR != (int)block)
+        {
+            small = chase(block);
+            largepages = saved;
+            memfree(block, CHASEBYTES);
+            block = memget(CHASEBYTES);
+        }
+        largepages = saved;
+        largewait();
+        if (SYSERR != (int)block)
+        {
+            large = chase(block);
+            memfree(block, CHASEBYTES);
+            printf("\t%u page chase: %lu cycles per link with 4 KB pages, "
+                   "%lu with 4 MB pages\n", CHASEPAGES, small, large);
+        }
+    }
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
@@ -1,9 +1,15 @@
 #include <stddef.h>
 #include <string.h>
 #include <stdio.h>
+#include <memory.h>
 #include <testsuite.h>
+#include <tsc.h>
 
 #define LEN_STR 7
+#define BENCH_MAX   (64 * 1024) /* largest block copied in the benchmark */
+#define BENCH_REPS  8           /* timed repetitions of each block size  */
+
+static void benchString(void);
 
 /**
  * Tests the string.h header in the Xinu Standard Library.
@@ -134,6 +140,39 @@ thread test_libString(bool verbose)
     s1 = memset(sJ, 'F', 3);
     failif(((0 != memcmp(sJ, "FFFDE", 5)) || (s1 != sJ)), "");
 
+    /* memmove */
+    testPrint(verbose, "Memory move (overlapping)");
+    char sK[27] = "abcdefghijklmnopqrstuvwxyz";
+
+    s1 = memmove(sK + 3, sK, 20);
+    failif(((0 != memcmp(sK, "abcabcdefghijklmnopqrstxyz", 26))
+            || (s1 != sK + 3)), "");
+    s1 = memmove(sK, sK + 5, 21);
+    failif(((0 != memcmp(sK, "cdefghijklmnopqrstxyzstxyz", 26))
+            || (s1 != sK)), "");
+
+    /* unaligned block copy and fill */
+    testPrint(verbose, "Memory copy and set (unaligned)");
+    char sL[40];
+    char sM[40];
+    int i;
+
+    for (i = 0; i < 40; i++)
+    {
+        sL[i] = i;
+        sM[i] = 0;
+    }
+    memcpy(sM + 3, sL + 1, 33);
+    memset(sL + 1, 'Z', 37);
+    failif(((0 != sM[2]) || (1 != sM[3]) || (33 != sM[35])
+            || (0 != sM[36]) || (0 != sL[0]) || ('Z' != sL[1])
+            || ('Z' != sL[37]) || (38 != sL[38])), "");
+
+    if (verbose)
+    {
+        benchString();
+    }
+
     if (passed)
     {
         testPass(TRUE, "");
@@ -145,3 +184,50 @@ thread test_libString(bool verbose)
 
     return OK;
 }
+
+/* Average cycles for one call of a block function on n bytes */
+#define BENCH(call, avg) { \
+        ulong t = rdtsc(); \
+        int r; \
+        for (r = 0; r < BENCH_REPS; r++) \
+        { \
+            call; \
+        } \
+        avg = (rdtsc() - t) / BENCH_REPS; \
+    }
+
+/**
+ * Prints the throughput of memcpy(), memset() and memmove() on blocks from
+ * 8 bytes to 64 KiB, both aligned and with source and destination at
+ * different offsets within a word.
+ */
+static void benchString(void)
+{
+    char *buf, *src, *dst;
+    ulong n, cpy, cpyu, set, mov;
+
+    buf = memget(2 * BENCH_MAX + 16);
+    if (SYSERR == (int)buf)
+    {
+        printf("\tNo memory for string benchmark\n");
+        return;
+    }
+    src = (char *)(((ulong)buf + 3) & ~3);
+    dst = src + BENCH_MAX + 8;
+    memset(src, 0x5A, BENCH_MAX + 4);
+
+    printf("\t%8s %10s %10s %10s %10s\n", "bytes", "memcpy",
+           "unaligned", "memset", "memmove");
+    for (n = 8; n <= BENCH_MAX; n *= 2)
+    {
+        BENCH(memcpy(dst, src, n), cpy);
+        BENCH(memcpy(dst + 1, src + 2, n), cpyu);
+        BENCH(memset(dst, r, n), set);
+        BENCH(memmove(src + 1, src, n), mov);
+        printf("\t%8u %10u %10u %10u %10u\n", (uint)n, (uint)cpy,
+               (uint)cpyu, (uint)set, (uint)mov);
+    }
+    printf("\t(cycles per call)\n");
+
+    memfree(buf, 2 * BENCH_MAX + 16);
+}
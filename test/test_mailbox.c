@@ -6,10 +6,24 @@
 #include <limits.h>
 #include <interrupt.h>
 #include <thread.h>
+#include <timer.h>
+#include <tsc.h>
+
+#define BATCH       32                  /* messages per batch           */
+#define BENCHMSGS   8192                /* messages timed per method    */
+#define WIDE        3                   /* ints in a multi-word message */
+#define SHORTWAIT   10                  /* ticks to wait for no message */
+#define LONGWAIT    1000                /* ticks to wait for a message  */
 
 /* function prototypes */
 static int producer(mailbox);
 static int consumer(mailbox);
+#if NMAILBOX
+static void benchmark(void);
+static thread latesender(mailbox);
+static thread selecter(mailbox);
+static thread timedreceiver(mailbox);
+#endif
 
 thread test_mailbox(bool verbose)
 {
@@ -28,6 +42,9 @@ thread test_mailbox(bool verbose)
     mailbox boxes[NMAILBOX + 1];        /* one spare, to test for overflow */
     mailbox overflow;
     irqmask im;
+    int batch[2 * BATCH];
+    mailbox pair[2];
+    ulong start;
 
     /* Test allocation of mailboxes */
     testPrint(verbose, "Allocate small mailbox");
@@ -255,6 +272,168 @@ thread test_mailbox(bool verbose)
 
     mailboxFree(testbox1);
 
+    /* Test batches, which stop at the room or messages available */
+
+    testPrint(verbose, "Send and receive batches");
+
+    testbox1 = mailboxAlloc(4);
+    for (i = 0; i < 2 * BATCH; i++)
+    {
+        batch[i] = i;
+    }
+    count = mailboxSendBatch(testbox1, batch, 6);
+    if ((4 != count) || (4 != mailboxCount(testbox1))
+        || (4 != mailboxReceiveBatch(testbox1, batch + BATCH, 8))
+        || (0 != batch[BATCH]) || (3 != batch[BATCH + 3])
+        || (2 != mailboxSendBatch(testbox1, batch + 4, 2))
+        || (4 != mailboxReceive(testbox1)))
+    {
+        passed = FALSE;
+        testFail(verbose, "batch moved the wrong messages");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
+    mailboxFree(testbox1);
+
+    /* Test mailboxes of multi-word messages */
+
+    testPrint(verbose, "Multi-word messages");
+
+    testbox1 = mailboxAllocWords(4, WIDE);
+    for (i = 0; i < 2 * WIDE; i++)
+    {
+        batch[i] = 100 + i;
+    }
+    if ((SYSERR == testbox1)
+        || (2 != mailboxSendBatch(testbox1, batch, 2))
+        || (SYSERR != mailboxSend(testbox1, 1))
+        || (2 != mailboxReceiveBatch(testbox1, batch + BATCH, 4))
+        || (100 != batch[BATCH]) || (105 != batch[BATCH + 2 * WIDE - 1]))
+    {
+        passed = FALSE;
+        testFail(verbose, "multi-word messages were not kept whole");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
+    mailboxFree(testbox1);
+
+    /* Test operations which return rather than block */
+
+    testPrint(verbose, "Try send and receive");
+
+    testbox1 = mailboxAlloc(1);
+    if ((TIMEOUT != mailboxTryReceive(testbox1))
+        || (OK != mailboxTrySend(testbox1, 7))
+        || (TIMEOUT != mailboxTrySend(testbox1, 8))
+        || (7 != mailboxTryReceive(testbox1)))
+    {
+        passed = FALSE;
+        testFail(verbose, "operation blocked or moved wrong message");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
+    testPrint(verbose, "Receive with timeout");
+
+    start = tmticks;
+    if ((TIMEOUT != mailboxReceiveTime(testbox1, SHORTWAIT))
+        || (tmticks - start < SHORTWAIT)
+        || (OK != mailboxSend(testbox1, 9))
+        || (9 != mailboxReceiveTime(testbox1, SHORTWAIT)))
+    {
+        passed = FALSE;
+        testFail(verbose, "did not time out or missed message");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
+    /* A second timed receiver queues behind the first instead of failing */
+
+    testPrint(verbose, "Two timed receivers on one mailbox");
+
+    recvclr();
+    consumertid = create((void *)timedreceiver, INITSTK, prio + 1,
+                         "timedreceiver", 1, testbox1);
+    ready(consumertid, RESCHED_YES);
+    if ((TIMEOUT != mailboxReceiveTime(testbox1, SHORTWAIT))
+        || (OK != mailboxSend(testbox1, 7))
+        || (7 != recvtime(LONGWAIT)))
+    {
+        passed = FALSE;
+        testFail(verbose, "timed receivers did not share the mailbox");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+    recvclr();
+
+    /* Test waiting on two mailboxes for a message sent to the second */
+
+    testPrint(verbose, "Select among mailboxes");
+
+    testbox2 = mailboxAlloc(1);
+    pair[0] = testbox1;
+    pair[1] = testbox2;
+    producertid = create((void *)latesender, INITSTK, prio + 1,
+                         "latesender", 1, testbox2);
+    ready(producertid, RESCHED_NO);
+    if ((TIMEOUT != mailboxSelect(pair, 2, 0))
+        || (testbox2 != mailboxSelect(pair, 2, LONGWAIT))
+        || (5 != mailboxTryReceive(testbox2))
+        || (TIMEOUT != mailboxSelect(pair, 2, SHORTWAIT)))
+    {
+        passed = FALSE;
+        testFail(verbose, "select did not return the ready mailbox");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
+    /* A mailbox being selected on is refused to a second selector */
+
+    testPrint(verbose, "Select on a mailbox already selected on");
+
+    consumertid = create((void *)selecter, INITSTK, prio + 1,
+                         "selecter", 1, testbox2);
+    ready(consumertid, RESCHED_YES);
+    count = mailboxSelect(pair, 2, 0);
+    /* Killing the selector frees its mailboxes */
+    kill(consumertid);
+    if (SYSERR != count)
+    {
+        passed = FALSE;
+        testFail(verbose, "second selector was not refused");
+    }
+    else if (TIMEOUT != mailboxSelect(pair, 2, 0))
+    {
+        passed = FALSE;
+        testFail(verbose, "killed selector kept its mailbox");
+    }
+    else
+    {
+        testPass(verbose, "");
+    }
+
+    mailboxFree(testbox1);
+    mailboxFree(testbox2);
+
+    if (verbose)
+    {
+        benchmark();
+    }
+
     /* Final report */
     if (TRUE == passed)
     {
@@ -293,4 +472,80 @@ thread consumer(mailbox box)
 
     return OK;
 }
+
+/*
+ * Send a message after the receiver has had time to start waiting.  This
+ * thread has its own page directory, so the send reaches the test thread's
+ * mailbox only because rings live in kernel memory.
+ */
+static thread latesender(mailbox box)
+{
+    sleep(SHORTWAIT);
+    mailboxSend(box, 5);
+    return OK;
+}
+
+/* Receive one message with a timeout and pass it to the parent */
+static thread timedreceiver(mailbox box)
+{
+    send(thrtab[thrcurrent].parent, mailboxReceiveTime(box, LONGWAIT));
+    return OK;
+}
+
+/* Select on a mailbox until killed */
+static thread selecter(mailbox box)
+{
+    mailboxSelect(&box, 1, -1);
+    return OK;
+}
+
+/*
+ * Time moving BENCHMSGS messages through a mailbox one at a time and then
+ * BATCH at a time.  Each round fills the mailbox then drains it, so nothing
+ * blocks and only the per-call overhead is measured.
+ */
+static void benchmark(void)
+{
+    mailbox box;
+    int msgs[BATCH];
+    ulong single, batched;
+    int i, j;
+
+    box = mailboxAlloc(BATCH);
+    if (SYSERR == box)
+    {
+        return;
+    }
+    for (i = 0; i < BATCH; i++)
+    {
+        msgs[i] = i;
+    }
+
+    single = rdtsc();
+    for (i = 0; i < BENCHMSGS; i += BATCH)
+    {
+        for (j = 0; j < BATCH; j++)
+        {
+            mailboxSend(box, msgs[j]);
+        }
+        for (j = 0; j < BATCH; j++)
+        {
+            msgs[j] = mailboxReceive(box);
+        }
+    }
+    single = rdtsc() - single;
+
+    batched = rdtsc();
+    for (i = 0; i < BENCHMSGS; i += BATCH)
+    {
+        mailboxSendBatch(box, msgs, BATCH);
+        mailboxReceiveBatch(box, msgs, BATCH);
+    }
+    batched = rdtsc() - batched;
+
+    mailboxFree(box);
+    printf("\t%d messages: %lu cycles each one at a time, "
+           "%lu in batches of %d\n", BENCHMSGS, single / BENCHMSGS,
+           batched / BENCHMSGS, BATCH);
+}
 #endif
@@ -1,12 +1,21 @@
 #include <stddef.h>
+#include <interrupt.h>
 #include <memory.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <testsuite.h>
+#include <thread.h>
+#include <tsc.h>
+
+#define NSMALL      64          /* small objects checked for overlap    */
+#define NCHURN      256         /* live blocks in the benchmark         */
+#define CHURN_ROUNDS 8          /* times each benchmark block is reused */
 
 /* function prototypes */
 static bool list_check(void);
 static void fatprocess(void);
+static bool slab_check(bool verbose);
+static void churn(bool verbose);
 
 /* test_memory -- allocates and frees memory; tests consistency of
  * memlist accounting.  Called by xsh_testsuite()
@@ -87,6 +96,16 @@ thread test_memory(bool verbose)
         }
     }
 
+    if (!slab_check(verbose))
+    {
+        passed = FALSE;
+    }
+
+    if (verbose)
+    {
+        churn(verbose);
+    }
+
     /* Final report */
     if (TRUE == passed)
     {
@@ -158,3 +177,143 @@ static void fatprocess(void)
         memfree(fnext, fnext->flen);
     }
 }
+
+/**
+ * Checks that small blocks come from the slab free lists: a freed block is
+ * reused for the next request of its size class, and live blocks of one
+ * class do not overlap.
+ */
+static bool slab_check(bool verbose)
+{
+    bool passed = TRUE;
+    uchar *blocks[NSMALL];
+    void *first, *again;
+    int i, j;
+
+    testPrint(verbose, "Small block reused from its size class");
+    first = memget(24);
+    failif(SYSERR == (int)first, "memget SYSERR");
+    if (SYSERR != (int)first)
+    {
+        memfree(first, 24);
+        again = memget(20);
+        failif(again != first, "");
+        memfree(again, 20);
+    }
+
+    testPrint(verbose, "Small blocks do not overlap");
+    for (i = 0; i < NSMALL; i++)
+    {
+        blocks[i] = memget(100);
+        if (SYSERR == (int)blocks[i])
+        {
+            blocks[i] = NULL;
+            passed = FALSE;
+            continue;
+        }
+        for (j = 0; j < 100; j++)
+        {
+            blocks[i][j] = i;
+        }
+    }
+    for (i = 0; i < NSMALL; i++)
+    {
+        if (NULL == blocks[i])
+        {
+            continue;
+        }
+        for (j = 0; j < 100; j++)
+        {
+            if (blocks[i][j] != i)
+            {
+                passed = FALSE;
+                break;
+            }
+        }
+        memfree(blocks[i], 100);
+    }
+    failif(!passed, "");
+
+    return passed;
+}
+
+/* Number of blocks on the current thread's free memlist */
+static int list_blocks(void)
+{
+    struct memblock *mptr;
+    int count = 0;
+
+    for (mptr = thrtab[thrcurrent].memlist.next; mptr != NULL;
+         mptr = mptr->next)
+    {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Measures malloc() and free() throughput with a working set of blocks
+ * of random sizes, once with small blocks served by the slabs and once with
+ * blocks large enough to take the first fit from the memlist, and reports
+ * how fragmented each leaves the memlist.
+ */
+static void churn(bool verbose)
+{
+    static void *live[NCHURN];
+    static uint sizes[] = { 8, SLAB_MAXSIZE - 8, SLAB_MAXSIZE * 2,
+        SLAB_MAXSIZE * 8
+    };
+    uint lo, hi, before, after;
+    ulong t, getcost, freecost;
+    irqmask im;
+    int pass, round, i, k;
+
+    printf("\t%-12s %10s %10s %12s\n", "sizes", "malloc", "free",
+           "memlist");
+    for (pass = 0; pass < 2; pass++)
+    {
+        lo = sizes[2 * pass];
+        hi = sizes[2 * pass + 1];
+        before = list_blocks();
+        getcost = 0;
+        freecost = 0;
+        for (i = 0; i < NCHURN; i++)
+        {
+            live[i] = NULL;
+        }
+
+        for (round = 0; round < CHURN_ROUNDS; round++)
+        {
+            for (i = 0; i < NCHURN; i++)
+            {
+                /* Replace blocks in a scattered order */
+                k = (i * 97 + round * 31) % NCHURN;
+
+                im = disable();
+                t = rdtsc();
+                if (NULL != live[k])
+                {
+                    free(live[k]);
+                }
+                freecost += rdtsc() - t;
+                t = rdtsc();
+                live[k] = malloc(lo + rand() % (hi - lo));
+                getcost += rdtsc() - t;
+                restore(im);
+            }
+        }
+        after = list_blocks();
+        for (i = 0; i < NCHURN; i++)
+        {
+            if (NULL != live[i])
+            {
+                free(live[i]);
+            }
+        }
+
+        printf("\t%5u-%-6u %10u %10u %5d->%-5d\n", lo, hi,
+               (uint)(getcost / (NCHURN * CHURN_ROUNDS)),
+               (uint)(freecost / (NCHURN * CHURN_ROUNDS)), before, after);
+    }
+    printf("\t(cycles per call; memlist blocks before and during)\n");
+}
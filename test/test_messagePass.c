@@ -7,7 +7,11 @@
 #include <interrupt.h>
 #include <thread.h>
 
+#define QUEUED  4               /* messages in the test thread's ring   */
+#define BURST   6               /* messages sent at once                */
+
 static thread recvthread(bool);
+static thread burstthread(tid_typ);
 
 /* test_messagePass -- Creates two threads; a receiver and a sender.  
  * Each testing send, receive, receive clear, and receive timeout. 
@@ -17,6 +21,8 @@ thread test_messagePass(bool verbose)
 {
     bool passed = TRUE;
     tid_typ recvtid;
+    uint drops;
+    int i, count;
 
     recvclr();
 
@@ -116,6 +122,61 @@ thread test_messagePass(bool verbose)
         }
     }
 
+    /* Message ring - burst beyond its size */
+    testPrint(verbose, "Queue burst of messages");
+    recvclr();                  /* the exit of recvthread, if any */
+    drops = thrtab[gettid()].msgdrops;
+    count = 0;
+    if (OK == msgqueue(gettid(), QUEUED))
+    {
+        for (i = 0; i < BURST; i++)
+        {
+            if (OK == send(gettid(), i))
+            {
+                count++;
+            }
+        }
+    }
+    if ((QUEUED == count) && (BURST - QUEUED + drops ==
+                              thrtab[gettid()].msgdrops)
+        && (0 == receive()) && (1 == receive()) && (2 == recvclr())
+        && (NOMSG == recvclr()))
+    {
+        testPass(verbose, "");
+    }
+    else
+    {
+        passed = FALSE;
+        testFail(verbose, "");
+    }
+
+    /* Message ring - sender waits for room instead of dropping */
+    testPrint(verbose, "Block sender on full ring");
+    recvtid = create((void *)burstthread, INITSTK, getprio(gettid()) + 1,
+                     "burstthread", 1, gettid());
+    drops = thrtab[gettid()].msgdrops;
+    count = 0;
+    if ((SYSERR != recvtid) && (OK == ready(recvtid, RESCHED_YES))
+        && (THRWAIT == thrtab[recvtid].state))
+    {
+        for (i = 0; i < BURST; i++)
+        {
+            if (i == receive())
+            {
+                count++;
+            }
+        }
+    }
+    if ((BURST == count) && (drops == thrtab[gettid()].msgdrops))
+    {
+        testPass(verbose, "");
+    }
+    else
+    {
+        passed = FALSE;
+        testFail(verbose, "");
+    }
+
     if (passed)
     {
         testPass(TRUE, "");
@@ -143,3 +204,15 @@ static thread recvthread(bool verbose)
 
     return SYSERR;
 }
+
+static thread burstthread(tid_typ parent)
+{
+    int i;
+
+    for (i = 0; i < BURST; i++)
+    {
+        sendwait(parent, i);
+    }
+
+    return OK;
+}
@@ -0,0 +1,186 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <clock.h>
+#include <monitor.h>
+#include <testsuite.h>
+#include <thread.h>
+#include <tsc.h>
+
+#define LOWPRIO     5                   /* owner of the monitor         */
+#define MIDPRIO     10                  /* busy thread starving owner   */
+#define HIGHPRIO    20                  /* waiter for the monitor       */
+#define CEILPRIO    25                  /* ceiling set on the monitor   */
+#define HOLDWORK    100000              /* loops run holding the lock   */
+#define ROUNDS      8                   /* inversions timed             */
+#define MONWAIT     1000                /* ms to wait for a round       */
+
+#if NMON
+
+static volatile bool waiting, done, stop;
+static volatile int heldprio, leftprio;
+static volatile ulong latency;
+
+/*
+ * Lock the monitor, hold it until the high priority thread is waiting,
+ * then do a fixed amount of work before unlocking.  Records the priority
+ * it ran at while holding the monitor and after unlocking it.
+ */
+static thread lowthread(monitor mon)
+{
+    volatile int i;
+
+    lock(mon);
+    while (!waiting && !stop)
+    {
+        ;
+    }
+    heldprio = getprio(thrcurrent);
+    for (i = 0; i < HOLDWORK; i++)
+    {
+        ;
+    }
+    unlock(mon);
+    leftprio = getprio(thrcurrent);
+    return OK;
+}
+
+/* Keep the processor busy at a priority between the other two */
+static thread midthread(void)
+{
+    while (!done && !stop)
+    {
+        ;
+    }
+    return OK;
+}
+
+/* Time how long it takes to get the monitor from the low priority owner */
+static thread highthread(monitor mon)
+{
+    ulong start;
+
+    waiting = TRUE;
+    start = rdtsc();
+    lock(mon);
+    latency = rdtsc() - start;
+    done = TRUE;
+    unlock(mon);
+    return OK;
+}
+
+/* Sleep until every thread of a round has run, or give up */
+static bool roundwait(tid_typ *tids, int n)
+{
+    int wait, i;
+    bool alive = TRUE;
+
+    for (wait = 0; wait < MONWAIT && alive; wait++)
+    {
+        sleep(1);
+        alive = FALSE;
+        for (i = 0; i < n; i++)
+        {
+            if (THRFREE != thrtab[tids[i]].state)
+            {
+                alive = TRUE;
+            }
+        }
+    }
+    stop = TRUE;
+    return !alive;
+}
+
+#endif                          /* NMON */
+
+/**
+ * Reproduces a priority inversion: a low priority thread owns a monitor
+ * which a high priority thread wants while a medium priority thread spins.
+ * Checks that the owner inherits the waiter's priority, drops it again on
+ * unlock, and runs at the monitor's ceiling when one is set.  Verbose runs
+ * report the worst time the high priority thread waited.
+ */
+thread test_monitor(bool verbose)
+{
+#if NMON
+    bool passed = TRUE;
+    monitor mon;
+    tid_typ tids[3];
+    ulong worst = 0;
+    int round;
+    bool finished;
+
+    mon = moncreate();
+    if (SYSERR == (int)mon)
+    {
+        testFail(TRUE, "");
+        return OK;
+    }
+
+    for (round = 0; round < ROUNDS; round++)
+    {
+        waiting = done = stop = FALSE;
+        heldprio = leftprio = 0;
+        tids[0] = create((void *)lowthread, INITSTK, LOWPRIO, "MONLOW", 1, mon);
+        ready(tids[0], RESCHED_NO);
+        /* Let the owner take the monitor before the others arrive */
+        while (0 == moncount(mon))
+        {
+            sleep(1);
+        }
+        tids[1] = create((void *)midthread, INITSTK, MIDPRIO, "MONMID", 0);
+        tids[2] = create((void *)highthread, INITSTK, HIGHPRIO, "MONHIGH",
+                         1, mon);
+        ready(tids[1], RESCHED_NO);
+        ready(tids[2], RESCHED_NO);
+        finished = roundwait(tids, 3);
+
+        if (0 == round)
+        {
+            testPrint(verbose, "Boost lock owner past busy thread");
+            failif(!finished || !done || (HIGHPRIO != heldprio), "");
+
+            testPrint(verbose, "Restore priority on unlock");
+            failif(LOWPRIO != leftprio, "");
+        }
+        if (!finished)
+        {
+            break;
+        }
+        if (latency > worst)
+        {
+            worst = latency;
+        }
+    }
+
+    if (verbose && (ROUNDS == round))
+    {
+        printf("\tworst wait for monitor over %d inversions: %lu cycles\n",
+               ROUNDS, worst);
+    }
+
+    testPrint(verbose, "Raise owner to monitor ceiling");
+    monceiling(mon, CEILPRIO);
+    /* Nobody waits, so any boost comes from the ceiling alone */
+    waiting = TRUE;
+    stop = FALSE;
+    heldprio = leftprio = 0;
+    tids[0] = create((void *)lowthread, INITSTK, LOWPRIO, "MONLOW", 1, mon);
+    ready(tids[0], RESCHED_NO);
+    finished = roundwait(tids, 1);
+    failif(!finished || (CEILPRIO != heldprio) || (LOWPRIO != leftprio), "");
+
+    monfree(mon);
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+#else
+    testSkip(TRUE, "");
+#endif                          /* NMON */
+    return OK;
+}
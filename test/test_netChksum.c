@@ -0,0 +1,161 @@
+/**
+ * @file     test_netChksum.c
+ *
+ */
+/* Embedded Xinu, Copyright (C) 2013.  All rights reserved. */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <interrupt.h>
+#include <network.h>
+#include <testsuite.h>
+#include <tsc.h>
+
+#if NETHER
+
+#define CHK_MAXLEN  1500        /* largest packet summed                */
+#define CHK_REPS    16          /* timed repetitions of each size       */
+
+static const uint chksizes[] = { 64, 128, 256, 512, 1024, CHK_MAXLEN };
+static uchar chksrc[CHK_MAXLEN + 8];
+static uchar chkdst[CHK_MAXLEN + 8];
+
+/* The one's complement sum 16 bits at a time, as netChksum() once did */
+static ushort chkReference(void *data, uint len)
+{
+    uint sum = 0;
+    ushort *ptr = data;
+
+    while (len > 1)
+    {
+        sum += *ptr++;
+        len -= 2;
+    }
+    if (len > 0)
+    {
+        sum += net2hs(*((uchar *)ptr) << 8);
+    }
+    while (sum >> 16)
+    {
+        sum = (sum >> 16) + (sum & 0xFFFF);
+    }
+    return ~sum;
+}
+
+/* Bytes per cycle, printed with two decimal places */
+static void chkRate(uint len, ulong cycles)
+{
+    uint rate = (len * 100) / (cycles ? cycles : 1);
+
+    printf(" %6u.%02u", rate / 100, rate % 100);
+}
+
+#endif /* NETHER */
+
+/**
+ * Tests the Internet checksum functions against a 16-bit reference, then
+ * compares their throughput on 64 to 1500 byte packets.
+ */
+thread test_netChksum(bool verbose)
+{
+#if NETHER
+    bool passed = TRUE;
+    uint len, off, split, sum;
+    ulong t, ref, chk, cpy, fused;
+    irqmask im;
+    int i, n;
+
+    for (i = 0; i < CHK_MAXLEN + 8; i++)
+    {
+        chksrc[i] = rand();
+    }
+
+    testPrint(verbose, "Checksum matches 16-bit sum");
+    for (len = 0; len <= 257; len++)
+    {
+        for (off = 0; off < 8; off += 2)
+        {
+            failif(netChksum(chksrc + off, len)
+                   != chkReference(chksrc + off, len), "");
+        }
+    }
+
+    testPrint(verbose, "Partial sums combine");
+    for (split = 0; split <= 200; split += 2)
+    {
+        sum = netChksumAdd(0, chksrc, split);
+        sum = netChksumAdd(sum, chksrc + split, 201 - split);
+        failif(netChksumFold(sum) != chkReference(chksrc, 201), "");
+    }
+
+    testPrint(verbose, "Copy and checksum");
+    for (off = 0; off < 4; off++)
+    {
+        len = CHK_MAXLEN - off;
+        memset(chkdst, 0, sizeof(chkdst));
+        sum = netChksumCopy(chkdst + off, chksrc + 2, len);
+        failif((0 != memcmp(chkdst + off, chksrc + 2, len))
+               || (netChksumFold(sum) != chkReference(chksrc + 2, len)),
+               "");
+    }
+
+    if (verbose)
+    {
+        printf("\t%6s %9s %9s %9s %9s\n", "bytes", "16-bit", "netChksum",
+               "copy+sum", "fused");
+        for (n = 0; n < sizeof(chksizes) / sizeof(chksizes[0]); n++)
+        {
+            len = chksizes[n];
+            im = disable();
+            t = rdtsc();
+            for (i = 0; i < CHK_REPS; i++)
+            {
+                chkReference(chksrc, len);
+            }
+            ref = rdtsc() - t;
+            t = rdtsc();
+            for (i = 0; i < CHK_REPS; i++)
+            {
+                netChksum(chksrc, len);
+            }
+            chk = rdtsc() - t;
+            t = rdtsc();
+            for (i = 0; i < CHK_REPS; i++)
+            {
+                memcpy(chkdst, chksrc, len);
+                netChksum(chkdst, len);
+            }
+            cpy = rdtsc() - t;
+            t = rdtsc();
+            for (i = 0; i < CHK_REPS; i++)
+            {
+                netChksumCopy(chkdst, chksrc, len);
+            }
+            fused = rdtsc() - t;
+            restore(im);
+
+            printf("\t%6u", len);
+            chkRate(len * CHK_REPS, ref);
+            chkRate(len * CHK_REPS, chk);
+            chkRate(len * CHK_REPS, cpy);
+            chkRate(len * CHK_REPS, fused);
+            printf("\n");
+        }
+        printf("\t(bytes per cycle)\n");
+    }
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+#else /* NETHER */
+    testSkip(TRUE, "");
+#endif /* NETHER == 0 */
+    return OK;
+}
@@ -0,0 +1,292 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <interrupt.h>
+#include <memory.h>
+#include <framealloc.h>
+#include <paging.h>
+#include <testsuite.h>
+#include <thread.h>
+#include <tsc.h>
+
+#define NPAGETHR    100         /* threads to create                    */
+#define HEAPTEST    (1 << 20)   /* bytes reserved in the heap test      */
+#define HEAPTOUCH   64          /* pages touched in the release test    */
+#define KILLSMALL   (1 << 16)   /* heap touched by the small kill test  */
+#define KILLLARGE   (1 << 26)   /* heap touched by the large kill test  */
+#define KILLSTRIDE  (1 << 18)   /* bytes between pages touched          */
+#define REAPWAIT    100         /* ms to wait for frames to come back   */
+#define STACKBIG    (1 << 20)   /* stack size in the growth test        */
+#define STACKDEPTH  32          /* calls deep the growth test recurses  */
+#define STACKFRAME  1024        /* bytes of locals in each of those     */
+
+static thread pageidle(void)
+{
+    receive();
+    return OK;
+}
+
+/* Touch one page every KILLSTRIDE bytes of an nbytes heap block and wait */
+static thread pagetouch(uint nbytes)
+{
+    char *block;
+    uint i;
+
+    block = memget(nbytes);
+    if (SYSERR != (int)block)
+    {
+        for (i = 0; i < nbytes; i += KILLSTRIDE)
+        {
+            block[i] = 1;
+        }
+    }
+    receive();
+    return OK;
+}
+
+/* Recurse depth calls deep with STACKFRAME bytes of locals in each */
+static int stackrecurse(int depth)
+{
+    volatile char frame[STACKFRAME];
+
+    frame[0] = depth;
+    frame[STACKFRAME - 1] = depth;
+    if (depth > 0)
+    {
+        return stackrecurse(depth - 1) + frame[0];
+    }
+    return frame[STACKFRAME - 1];
+}
+
+static thread stackgrow(int depth)
+{
+    stackrecurse(depth);
+    receive();
+    return OK;
+}
+
+/*
+ * Kill a thread holding nbytes of touched heap, report how long kill() took
+ * and check that every frame comes back once the reaper has run.
+ */
+static bool killtime(bool verbose, uint nbytes)
+{
+    tid_typ tid;
+    uint freebefore, rss;
+    ulong t;
+    int i;
+
+    freebefore = numfreeframes;
+    tid = create((void *)pagetouch, INITSTK, thrtab[thrcurrent].prio + 1,
+                 "PAGETOUCH", 1, nbytes);
+    if (SYSERR == tid)
+    {
+        return FALSE;
+    }
+    /* Runs immediately and blocks in receive() */
+    ready(tid, RESCHED_YES);
+    rss = thrtab[tid].rss;
+
+    t = rdtsc();
+    kill(tid);
+    t = rdtsc() - t;
+    recvclr();
+
+    /* The reaper runs at our priority, so it frees the frames once we sleep */
+    for (i = 0; i < REAPWAIT && numfreeframes + 2 < freebefore; i++)
+    {
+        sleep(1);
+    }
+    if (verbose)
+    {
+        printf("\t%8u byte heap, %4u pages: kill() %8lu cycles\n",
+               nbytes, rss, t);
+    }
+    return numfreeframes + 2 >= freebefore;
+}
+
+/**
+ * Checks that stacks and heap memory are backed only when touched.  Creates
+ * up to NPAGETHR threads with INITSTK stacks and reports the frames they
+ * hold, then reserves a large heap block and touches one byte of it.
+ * Then touches HEAPTOUCH pages of a heap block and checks that freeing
+ * it hands their frames back, and that the heap break is raised for a
+ * block which does not fit and lowered once it is freed.  Finally times kill() of threads with small
+ * and large touched heaps, checks that a thread with a big stack only backs
+ * the part it uses, and checks the thread's resident count against a walk
+ * of its page tables.
+ */
+thread test_pagefault(bool verbose)
+{
+    bool passed = TRUE;
+    tid_typ tids[NPAGETHR];
+    uint freebefore, resident, faults, rss, peak, oldbrk, size;
+    tid_typ tid;
+    struct pagestat stat;
+    irqmask im;
+    bool saved;
+    int i, nthr;
+    char *block;
+
+    /* Threads with large stacks */
+    testPrint(verbose, "Create threads with INITSTK stacks");
+    freebefore = numfreeframes;
+    for (nthr = 0; nthr < NPAGETHR; nthr++)
+    {
+        tids[nthr] = create((void *)pageidle, INITSTK,
+                            thrtab[thrcurrent].prio + 1, "PAGEIDLE", 0);
+        if (SYSERR == tids[nthr])
+        {
+            break;
+        }
+        /* Runs immediately and blocks in receive() */
+        ready(tids[nthr], RESCHED_YES);
+    }
+    resident = freebefore - numfreeframes;
+    failif(0 == nthr, "no threads created");
+
+    if (nthr > 0)
+    {
+        testPrint(verbose, "Resident frames below stack size");
+        failif(resident / nthr >= INITSTK / FRAME_SIZE, "");
+        if (verbose)
+        {
+            printf("\t%d threads with %d byte stacks: %u resident frames, "
+                   "%u per thread\n", nthr, INITSTK, resident,
+                   resident / nthr);
+        }
+    }
+
+    for (i = 0; i < nthr; i++)
+    {
+        send(tids[i], 0);
+        recvclr();
+    }
+    if (verbose)
+    {
+        printf("\t%u frames still held after threads exited\n",
+               freebefore - numfreeframes);
+    }
+
+    /* Heap reservation */
+    testPrint(verbose, "Reserve heap without backing it");
+    freebefore = numfreeframes;
+    block = memget(HEAPTEST);
+    failif((SYSERR == (int)block)
+           || (freebefore - numfreeframes > 2), "");
+
+    if (SYSERR != (int)block)
+    {
+        testPrint(verbose, "Touch heap page on demand");
+        freebefore = numfreeframes;
+        faults = thrtab[thrcurrent].pgfaults;
+        block[HEAPTEST / 2] = 1;
+        failif((1 != block[HEAPTEST / 2])
+               || (thrtab[thrcurrent].pgfaults != faults + 1)
+               || (freebefore - numfreeframes > 2), "");
+        memfree(block, HEAPTEST);
+    }
+
+    /* Frames released by memfree() */
+    testPrint(verbose, "Release touched heap pages on free");
+    block = memget(HEAPTEST);
+    failif(SYSERR == (int)block, "");
+    if (SYSERR != (int)block)
+    {
+        freebefore = numfreeframes;
+        rss = thrtab[thrcurrent].rss;
+        for (i = 0; i < HEAPTOUCH; i++)
+        {
+            block[i * FRAME_SIZE] = 1;
+        }
+        resident = thrtab[thrcurrent].rss - rss;
+        memfree(block, HEAPTEST);
+        if (verbose)
+        {
+            printf("\t%u pages resident after touching, %d after free\n",
+                   resident, (int)(thrtab[thrcurrent].rss - rss));
+        }
+        failif((resident < HEAPTOUCH)
+               || (thrtab[thrcurrent].rss > rss + 2)
+               || (freebefore > numfreeframes + 2), "");
+    }
+
+    /* The break follows the heap up and back down */
+    testPrint(verbose, "Raise heap break and lower it on free");
+    oldbrk = thrtab[thrcurrent].brk;
+    size = thrtab[thrcurrent].memlist.length + HEAPTEST;
+    block = memget(size);
+    failif((SYSERR == (int)block)
+           || (sbrk(0) != (void *)thrtab[thrcurrent].brk)
+           || (thrtab[thrcurrent].brk < (uint)block + size), "");
+    if (SYSERR != (int)block)
+    {
+        memfree(block, size);
+        failif(thrtab[thrcurrent].brk > oldbrk, "");
+        if (verbose)
+        {
+            printf("\tbreak 0x%08X, raised for %u bytes, lowered to "
+                   "0x%08X\n", oldbrk, size, thrtab[thrcurrent].brk);
+        }
+    }
+
+    /* Teardown of killed threads, with sparse 4 KB pages throughout */
+    testPrint(verbose, "Reclaim frames of killed threads");
+    saved = largepages;
+    largepages = FALSE;
+    failif(!killtime(verbose, KILLSMALL) || !killtime(verbose, KILLLARGE),
+           "");
+    largepages = saved;
+
+    /* Stack pages backed as recursion reaches them */
+    testPrint(verbose, "Grow stack on demand");
+    tid = create((void *)stackgrow, STACKBIG, thrtab[thrcurrent].prio + 1,
+                 "STACKGROW", 1, STACKDEPTH);
+    failif(SYSERR == tid, "");
+    if (SYSERR != tid)
+    {
+        /* Runs immediately and blocks in receive() */
+        ready(tid, RESCHED_YES);
+        peak = thrtab[tid].stkpeak;
+        rss = thrtab[tid].rss;
+        send(tid, 0);
+        recvclr();
+        if (verbose)
+        {
+            printf("\t%d byte stack, %d calls deep: %u pages used, "
+                   "%u resident\n", STACKBIG, STACKDEPTH, peak, rss);
+        }
+        failif((peak < STACKDEPTH * STACKFRAME / FRAME_SIZE)
+               || (peak > 2 * STACKDEPTH * STACKFRAME / FRAME_SIZE)
+               || (rss >= STACKBIG / FRAME_SIZE / 2), "");
+    }
+
+    /* The resident count kept along the way matches the page tables */
+    testPrint(verbose, "Page table walk agrees with resident count");
+    im = disable();
+    pagewalk(thrtab[thrcurrent].pagedir, &stat);
+    rss = thrtab[thrcurrent].rss;
+    restore(im);
+    failif(stat.pages != rss, "");
+    if (verbose)
+    {
+        printf("\t%u pages in %u page tables, %u counted resident\n",
+               stat.pages, stat.tables, rss);
+    }
+
+    if (verbose)
+    {
+        printf("\t%u page faults resolved by this thread\n",
+               thrtab[thrcurrent].pgfaults);
+    }
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
@@ -1,9 +1,23 @@
 #include <stddef.h>
 #include <thread.h>
 #include <stdio.h>
+#include <clock.h>
+#include <interrupt.h>
 #include <testsuite.h>
+#include <tsc.h>
 
 #define TIMES 5
+#define NYIELDS     100         /* yields per benchmark thread          */
+#define CALTICKS    10          /* clock ticks used to calibrate TSC    */
+
+/* Benchmark state lives in kernel memory, which every thread shares */
+static volatile uint benchstart;        /* TSC when first yielder ran   */
+static volatile uint benchend;          /* TSC when first yielder done  */
+static volatile uint benchswitches;     /* yields up to benchend        */
+static volatile bool benchdone;
+
+static void benchswitch(bool verbose, int nready, uint cyclesperus);
+static uint cyclesperus(void);
 
 static void t4(int times, uchar *testArray, int *shared)
 {
@@ -26,6 +40,31 @@ static void t4(int times, uchar *testArray, int *shared)
     }
 }
 
+static thread yielder(void)
+{
+    int i;
+
+    if (0 == benchstart)
+    {
+        benchstart = rdtsc();
+    }
+    for (i = 0; i < NYIELDS; i++)
+    {
+        if (!benchdone)
+        {
+            benchswitches++;
+        }
+        yield();
+    }
+    /* Stop the clock before any yielder exits, so kill() is not timed */
+    if (!benchdone)
+    {
+        benchend = rdtsc();
+        benchdone = TRUE;
+    }
+    return OK;
+}
+
 thread test_schedule(bool verbose)
 {
     char str[50];
@@ -91,6 +130,16 @@ thread test_schedule(bool verbose)
         }
     }
 
+    /* Cost of a switch as the ready queue grows */
+    if (verbose)
+    {
+        uint cycles = cyclesperus();
+
+        benchswitch(verbose, 2, cycles);
+        benchswitch(verbose, 20, cycles);
+        benchswitch(verbose, 100, cycles);
+    }
+
     if (TRUE == passed)
     {
         testPass(TRUE, "");
@@ -102,3 +151,86 @@ thread test_schedule(bool verbose)
 
     return OK;
 }
+
+/**
+ * Time round-robin yields among nready equal-priority threads, or as many
+ * as can be created.
+ */
+static void benchswitch(bool verbose, int nready, uint cyclesperus)
+{
+    int i, n;
+    uint cycles;
+    irqmask im;
+    tid_typ tid;
+
+    im = disable();
+    benchstart = 0;
+    benchend = 0;
+    benchswitches = 0;
+    benchdone = FALSE;
+    for (n = 0; n < nready; n++)
+    {
+        tid = create((void *)yielder, INITSTK, getprio(gettid()) + 1,
+                     "YIELDER", 0);
+        if (SYSERR == tid)
+        {
+            break;
+        }
+        ready(tid, RESCHED_NO);
+    }
+    restore(im);
+
+    /* The higher priority yielders run until every one has exited */
+    yield();
+    for (i = 0; i < n; i++)
+    {
+        recvclr();
+    }
+
+    if (0 == benchswitches)
+    {
+        return;
+    }
+    cycles = (benchend - benchstart) / benchswitches;
+    if (0 == cyclesperus)
+    {
+        printf("\t%3d ready threads: %u cycles per switch\n", n, cycles);
+    }
+    else
+    {
+        printf("\t%3d ready threads: %u ns per switch\n", n,
+               cycles * 1000 / cyclesperus);
+    }
+}
+
+/**
+ * Calibrate the time-stamp counter against the clock interrupt.
+ * @return TSC cycles per microsecond, or 0 if the clock is not ticking
+ */
+static uint cyclesperus(void)
+{
+    ulong ticks;
+    uint start, t;
+    int i;
+
+    ticks = clkticks;
+    start = rdtsc();
+    for (i = 0; i <= CALTICKS; i++)
+    {
+        /* wait for a tick, giving up after about 2^30 cycles */
+        while (ticks == clkticks)
+        {
+            if (rdtsc() - start > 0x40000000)
+            {
+                return 0;
+            }
+        }
+        ticks = clkticks;
+        if (0 == i)
+        {
+            start = rdtsc();
+        }
+    }
+    t = rdtsc() - start;
+    return t / (CALTICKS * (1000000 / CLKTICKS_PER_SEC));
+}
@@ -0,0 +1,133 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <memory.h>
+#include <framealloc.h>
+#include <paging.h>
+#include <shm.h>
+#include <testsuite.h>
+#include <thread.h>
+
+#define SHMPAGES    8                   /* pages in the test segment    */
+#define SHMBYTES    (SHMPAGES * FRAME_SIZE)
+#define SHMWAIT     100                 /* ms to wait for the reaper    */
+
+/*
+ * Attach the segment in a thread with its own page directory, check the
+ * pattern the parent wrote, and answer by writing into the segment.
+ */
+static thread shmchild(int shmid, tid_typ parent)
+{
+    uchar *seg;
+    uint i;
+    bool same = TRUE;
+
+    seg = shmattach(shmid, NULL);
+    if (SYSERR == (int)seg)
+    {
+        send(parent, FALSE);
+        return OK;
+    }
+    for (i = 0; i < SHMBYTES; i++)
+    {
+        if (seg[i] != (uchar)i)
+        {
+            same = FALSE;
+        }
+    }
+    seg[0] = 0xFF;
+    seg[SHMBYTES - 1] = 0xFE;
+    send(parent, same && (OK == shmdetach(seg)));
+    return OK;
+}
+
+/**
+ * Checks that a shared memory segment attached in two threads with
+ * separate page directories maps the same frames in both, and that the
+ * frames go back to the allocator only once the segment is freed and
+ * unmapped everywhere.
+ */
+thread test_shm(bool verbose)
+{
+    bool passed = TRUE;
+    int shmid;
+    tid_typ tid;
+    uchar *seg, *block;
+    uint i, freebefore;
+    int wait;
+
+    freebefore = numfreeframes;
+
+    testPrint(verbose, "Create segment");
+    shmid = shmget(SHM_PRIVATE, SHMBYTES);
+    failif(SYSERR == shmid, "");
+    if (SYSERR == shmid)
+    {
+        testFail(TRUE, "");
+        return OK;
+    }
+
+    testPrint(verbose, "Attach segment");
+    seg = shmattach(shmid, NULL);
+    failif((SYSERR == (int)seg) || ((uint)seg & (FRAME_SIZE - 1)), "");
+    if (SYSERR != (int)seg)
+    {
+        for (i = 0; i < SHMBYTES; i++)
+        {
+            seg[i] = (uchar)i;
+        }
+
+        testPrint(verbose, "Share writes with another address space");
+        tid = create((void *)shmchild, INITSTK, thrtab[thrcurrent].prio + 1,
+                     "SHMCHILD", 2, shmid, thrcurrent);
+        failif(SYSERR == tid, "");
+        if (SYSERR != tid)
+        {
+            recvclr();
+            ready(tid, RESCHED_YES);
+            failif((TRUE != receive()) || (0xFF != seg[0])
+                   || (0xFE != seg[SHMBYTES - 1]), "");
+        }
+
+        testPrint(verbose, "Keep frames mapped past shmfree");
+        failif((OK != shmfree(shmid)) || (0xFF != seg[0]), "");
+
+        testPrint(verbose, "Detach segment");
+        failif((OK != shmdetach(seg)) || (SYSERR != shmdetach(seg)), "");
+    }
+    else
+    {
+        shmfree(shmid);
+    }
+
+    testPrint(verbose, "Attach at a chosen address");
+    shmid = shmget(SHM_PRIVATE, FRAME_SIZE);
+    block = memget(2 * FRAME_SIZE);
+    failif((SYSERR == shmid) || (SYSERR == (int)block), "");
+    if ((SYSERR != shmid) && (SYSERR != (int)block))
+    {
+        seg = (uchar *)truncframe((uint)block + FRAME_SIZE - 1);
+        failif((seg != shmattach(shmid, seg)) || (0 != seg[0])
+               || (OK != shmdetach(seg)), "");
+        memfree(block, 2 * FRAME_SIZE);
+        shmfree(shmid);
+    }
+
+    testPrint(verbose, "Return frames once unmapped everywhere");
+    /* The child's address space is freed by the reaper, at a lower priority */
+    for (wait = 0; wait < SHMWAIT && numfreeframes + 2 < freebefore; wait++)
+    {
+        sleep(1);
+    }
+    failif(freebefore > numfreeframes + 2, "");
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
@@ -0,0 +1,102 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <interrupt.h>
+#include <testsuite.h>
+#include <thread.h>
+#include <timer.h>
+#include <tsc.h>
+
+#define NORDERED    5           /* timers in the ordering check         */
+#define NTIMED      64          /* timers set and cancelled for timing  */
+
+/* The clock interrupt reaches these from any address space */
+static struct tment ordered[NORDERED];
+static struct tment timed[NTIMED];
+static int fired[NORDERED];
+static int nfired;
+
+static void tmrecord(int arg)
+{
+    if (nfired < NORDERED)
+    {
+        fired[nfired++] = arg;
+    }
+}
+
+/**
+ * Tests the timer wheel: expiry order across wheel levels, cancellation,
+ * sleep() duration, and the cost of setting and cancelling timers.
+ */
+thread test_timer(bool verbose)
+{
+    bool passed = TRUE;
+    ulong start, setcost, cancelcost, t;
+    irqmask im;
+    int i;
+
+    testPrint(verbose, "Timers fire in expiry order");
+    nfired = 0;
+    im = disable();
+    tmset(&ordered[0], 5, tmrecord, 0);
+    tmset(&ordered[1], 2, tmrecord, 1);
+    tmset(&ordered[2], 70, tmrecord, 2);  /* on level 1, cascaded down */
+    tmset(&ordered[3], 3, tmrecord, 3);
+    tmset(&ordered[4], 40, tmrecord, 4);
+    tmcancel(&ordered[4]);
+    restore(im);
+    sleep(150);
+    failif((4 != nfired) || (1 != fired[0]) || (3 != fired[1])
+           || (0 != fired[2]) || (2 != fired[3]), "");
+
+    testPrint(verbose, "Far timers keep their expiry");
+    im = disable();
+    tmset(&ordered[0], 300000, tmrecord, 0);
+    failif(!tmpending(&ordered[0]) || (300000 != tmremain(&ordered[0])),
+           "");
+    tmcancel(&ordered[0]);
+    failif(tmpending(&ordered[0]) || (0 != tmremain(&ordered[0])), "");
+    restore(im);
+
+    testPrint(verbose, "Sleep lasts its full time");
+    start = tmticks;
+    sleep(20);
+    failif(tmticks - start < 20, "");
+
+    testPrint(verbose, "Set and cancel cost");
+    setcost = 0;
+    cancelcost = 0;
+    im = disable();
+    for (i = 0; i < NTIMED; i++)
+    {
+        t = rdtsc();
+        tmset(&timed[i], 1 + (i * 7919) % 100000, tmrecord, i);
+        setcost += rdtsc() - t;
+    }
+    for (i = 0; i < NTIMED; i++)
+    {
+        t = rdtsc();
+        tmcancel(&timed[i]);
+        cancelcost += rdtsc() - t;
+    }
+    restore(im);
+    for (i = 0; i < NTIMED; i++)
+    {
+        failif(tmpending(&timed[i]), "");
+    }
+    if (verbose && passed)
+    {
+        printf("\ttmset(): avg %u cycles, tmcancel(): avg %u cycles\n",
+               (uint)(setcost / NTIMED), (uint)(cancelcost / NTIMED));
+    }
+
+    if (passed)
+    {
+        testPass(TRUE, "");
+    }
+    else
+    {
+        testFail(TRUE, "");
+    }
+
+    return OK;
+}
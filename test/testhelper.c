@@ -37,6 +37,16 @@ struct testcase testtab[] = {
     {"IP", test_ip},
     {"User Memory", test_umemory},
     {"Simple TLB", test_tlb},
+    {"Frame Allocator", test_framealloc},
+    {"Demand Paging", test_pagefault},
+    {"Address Space Clone", test_clone},
+    {"Temporary Kernel Mappings", test_kmap},
+    {"Context Switch TLB Cost", test_ctxsw},
+    {"Timer Wheel", test_timer},
+    {"Network Checksum", test_netChksum},
+    {"Large Pages", test_largepage},
+    {"Shared Memory", test_shm},
+    {"Monitor Priority Inheritance", test_monitor},
 };
 
 int ntests = sizeof(testtab) / sizeof(struct testcase);